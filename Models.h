@@ -52,9 +52,38 @@ struct Flight {
     std::string arrival;    // e.g., "16:45"
     std::string duration;   // e.g., "2h 15m"
     int price;              // e.g., 4500
-
-    // Automatic JSON Conversion
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Flight, id, airline, from_code, to_code, date, departure, arrival, duration, price)
+    int capacity;           // Total seats on this flight, e.g., 180
 };
 
+// Used when a stored or posted flight has no "capacity"
+const int DEFAULT_FLIGHT_CAPACITY = 180;
+
+inline void to_json(json& j, const Flight& f) {
+    j = json{
+        {"id", f.id},
+        {"airline", f.airline},
+        {"from_code", f.from_code},
+        {"to_code", f.to_code},
+        {"date", f.date},
+        {"departure", f.departure},
+        {"arrival", f.arrival},
+        {"duration", f.duration},
+        {"price", f.price},
+        {"capacity", f.capacity}
+    };
+}
+
+inline void from_json(const json& j, Flight& f) {
+    j.at("id").get_to(f.id);
+    j.at("airline").get_to(f.airline);
+    j.at("from_code").get_to(f.from_code);
+    j.at("to_code").get_to(f.to_code);
+    j.at("date").get_to(f.date);
+    j.at("departure").get_to(f.departure);
+    j.at("arrival").get_to(f.arrival);
+    j.at("duration").get_to(f.duration);
+    j.at("price").get_to(f.price);
+    f.capacity = j.value("capacity", DEFAULT_FLIGHT_CAPACITY); // Optional for older data
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,369 @@
+#include "analytics.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+// ==========================================
+// COLUMN STORE
+// ==========================================
+
+uint16_t FlightColumns::intern(unordered_map<string, uint16_t>& ids, vector<string>& names, const string& key) {
+    auto it = ids.find(key);
+    if (it != ids.end()) return it->second;
+    uint16_t id = (uint16_t)names.size();
+    ids.emplace(key, id);
+    names.push_back(key);
+    return id;
+}
+
+void FlightColumns::add(const string& o, const string& d, const string& a, const string& dt, int p) {
+    origin.push_back(intern(airport_ids, airports, o));
+    destination.push_back(intern(airport_ids, airports, d));
+    airline.push_back(intern(airline_ids, airlines, a));
+    date.push_back(intern(date_ids, dates, dt));
+    price.push_back(p);
+}
+
+void FlightColumns::finish() {
+    // Renumber dates in calendar order ("YYYY-MM-DD" sorts as text)
+    vector<uint16_t> order(dates.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (uint16_t)i;
+    sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) { return dates[a] < dates[b]; });
+
+    vector<uint16_t> remap(dates.size());
+    vector<string> sorted(dates.size());
+    for (size_t rank = 0; rank < order.size(); ++rank) {
+        remap[order[rank]] = (uint16_t)rank;
+        sorted[rank] = dates[order[rank]];
+    }
+    for (auto& d : date) d = remap[d];
+    dates.swap(sorted);
+    date_ids.clear();
+    for (size_t i = 0; i < dates.size(); ++i) date_ids[dates[i]] = (uint16_t)i;
+}
+
+FlightColumns FlightColumns::from_json(const json& flights) {
+    FlightColumns cols;
+    for (const auto& f : flights) {
+        cols.add(f["from_code"], f["to_code"], f["airline"], f["date"], f["price"]);
+    }
+    cols.finish();
+    return cols;
+}
+
+int FlightColumns::airport_id(const string& code) const {
+    auto it = airport_ids.find(code);
+    return it == airport_ids.end() ? -1 : it->second;
+}
+
+int FlightColumns::airline_id(const string& name) const {
+    auto it = airline_ids.find(name);
+    return it == airline_ids.end() ? -1 : it->second;
+}
+
+int FlightColumns::date_lower_bound(const string& d) const {
+    return (int)(lower_bound(dates.begin(), dates.end(), d) - dates.begin());
+}
+
+bool parse_group_keys(const string& csv, vector<AnalyticsQuery::GroupKey>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start <= csv.size()) {
+        size_t comma = csv.find(',', start);
+        string key = csv.substr(start, comma == string::npos ? string::npos : comma - start);
+        if (key == "route") out.push_back(AnalyticsQuery::ROUTE);
+        else if (key == "origin") out.push_back(AnalyticsQuery::ORIGIN);
+        else if (key == "destination") out.push_back(AnalyticsQuery::DESTINATION);
+        else if (key == "airline") out.push_back(AnalyticsQuery::AIRLINE);
+        else if (key == "date") out.push_back(AnalyticsQuery::DATE);
+        else if (!key.empty()) return false;
+        if (comma == string::npos) break;
+        start = comma + 1;
+    }
+    return true;
+}
+
+// ==========================================
+// PARALLEL GROUP-BY
+// ==========================================
+// Each worker filters its slice of rows with branch-free passes over the
+// packed columns and tags every match with a group id. When the group space
+// is small enough to address directly (the usual case: routes x dates,
+// airlines, ...), matches are then counting-sorted by group into one flat
+// fare array, so each group's fares are contiguous for the median. Very
+// large key spaces fall back to per-worker hash maps.
+
+namespace {
+
+// Filter bounds as id / value ranges, so every predicate is a compare
+struct Bounds {
+    int origin = -1, destination = -1, airline = -1;
+    int date_lo = 0, date_hi = 0xffff;
+    int32_t price_lo = INT32_MIN, price_hi = INT32_MAX;
+};
+
+// Final numbers for one group; `parts` holds the id of each key component
+// (two for a route)
+struct GroupStats {
+    vector<uint32_t> parts;
+    size_t count = 0;
+    int32_t min = 0, median = 0, max = 0;
+    long long sum = 0;
+    vector<uint32_t> airline_counts;
+};
+
+// Mixed-radix layout of the group key over the components of group_by
+struct KeyLayout {
+    vector<uint32_t> radix; // One entry per component
+    uint64_t groups = 1;    // Product of the radices
+
+    KeyLayout(const FlightColumns& c, const vector<AnalyticsQuery::GroupKey>& keys) {
+        for (auto k : keys) {
+            if (k == AnalyticsQuery::ROUTE) { radix.push_back((uint32_t)c.airports.size()); radix.push_back((uint32_t)c.airports.size()); }
+            else if (k == AnalyticsQuery::AIRLINE) radix.push_back((uint32_t)c.airlines.size());
+            else if (k == AnalyticsQuery::DATE) radix.push_back((uint32_t)c.dates.size());
+            else radix.push_back((uint32_t)c.airports.size());
+        }
+        for (uint32_t r : radix) groups *= max<uint32_t>(r, 1);
+    }
+
+    uint64_t encode(const FlightColumns& c, const vector<AnalyticsQuery::GroupKey>& keys, size_t row) const {
+        uint64_t key = 0;
+        size_t i = 0;
+        for (auto k : keys) {
+            switch (k) {
+                case AnalyticsQuery::ROUTE:
+                    key = key * radix[i] + c.origin[row]; i++;
+                    key = key * radix[i] + c.destination[row]; i++;
+                    break;
+                case AnalyticsQuery::ORIGIN: key = key * radix[i++] + c.origin[row]; break;
+                case AnalyticsQuery::DESTINATION: key = key * radix[i++] + c.destination[row]; break;
+                case AnalyticsQuery::AIRLINE: key = key * radix[i++] + c.airline[row]; break;
+                case AnalyticsQuery::DATE: key = key * radix[i++] + c.date[row]; break;
+            }
+        }
+        return key;
+    }
+
+    vector<uint32_t> decode(uint64_t key) const {
+        vector<uint32_t> parts(radix.size());
+        for (size_t i = radix.size(); i-- > 0;) {
+            parts[i] = (uint32_t)(key % radix[i]);
+            key /= radix[i];
+        }
+        return parts;
+    }
+};
+
+const uint64_t DENSE_GROUP_LIMIT = 1u << 20;
+
+// Runs fn(t, lo, hi) over `n` items split across `threads` workers
+template <typename Fn>
+void parallel_for(size_t n, unsigned threads, Fn fn) {
+    vector<thread> workers;
+    size_t chunk = (n + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        size_t lo = min(n, t * chunk), hi = min(n, lo + chunk);
+        if (t + 1 == threads) fn(t, lo, hi); // Use this thread too
+        else workers.emplace_back(fn, t, lo, hi);
+    }
+    for (auto& w : workers) w.join();
+}
+
+// Appends (row, key) for every row of [lo, hi) that passes the filters
+void filter_rows(const FlightColumns& c, const Bounds& b, const KeyLayout& layout,
+                 const vector<AnalyticsQuery::GroupKey>& keys, size_t lo, size_t hi,
+                 vector<uint32_t>& rows, vector<uint64_t>& group_keys) {
+    const size_t BLOCK = 4096;
+    uint8_t keep[BLOCK];
+    const int32_t* price = c.price.data();
+    const uint16_t* origin = c.origin.data();
+    const uint16_t* dest = c.destination.data();
+    const uint16_t* airline = c.airline.data();
+    const uint16_t* date = c.date.data();
+
+    for (size_t base = lo; base < hi; base += BLOCK) {
+        size_t n = min(BLOCK, hi - base);
+
+        // Branch-free predicate passes over packed columns (auto-vectorizable)
+        for (size_t i = 0; i < n; ++i) {
+            keep[i] = (uint8_t)((price[base + i] >= b.price_lo) & (price[base + i] <= b.price_hi) &
+                                (date[base + i] >= b.date_lo) & (date[base + i] <= b.date_hi));
+        }
+        if (b.origin >= 0) for (size_t i = 0; i < n; ++i) keep[i] &= (uint8_t)(origin[base + i] == b.origin);
+        if (b.destination >= 0) for (size_t i = 0; i < n; ++i) keep[i] &= (uint8_t)(dest[base + i] == b.destination);
+        if (b.airline >= 0) for (size_t i = 0; i < n; ++i) keep[i] &= (uint8_t)(airline[base + i] == b.airline);
+
+        for (size_t i = 0; i < n; ++i) {
+            if (!keep[i]) continue;
+            rows.push_back((uint32_t)(base + i));
+            group_keys.push_back(layout.encode(c, keys, base + i));
+        }
+    }
+}
+
+void finish_group(GroupStats& g, int32_t* fares, const uint16_t* fare_airlines, size_t n, size_t n_airlines) {
+    g.count = n;
+    g.airline_counts.assign(n_airlines, 0);
+    g.min = INT32_MAX;
+    g.max = INT32_MIN;
+    for (size_t i = 0; i < n; ++i) {
+        g.min = min(g.min, fares[i]);
+        g.max = max(g.max, fares[i]);
+        g.sum += fares[i];
+        g.airline_counts[fare_airlines[i]]++;
+    }
+    nth_element(fares, fares + n / 2, fares + n);
+    g.median = fares[n / 2];
+}
+
+vector<GroupStats> group_dense(const FlightColumns& c, const KeyLayout& layout,
+                               const vector<vector<uint32_t>>& rows, const vector<vector<uint64_t>>& keys,
+                               unsigned threads) {
+    size_t groups = (size_t)layout.groups;
+
+    // Per-worker counts -> global offsets -> per-worker write cursors
+    vector<vector<uint32_t>> cursor(threads, vector<uint32_t>(groups, 0));
+    parallel_for(threads, threads, [&](unsigned, size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) for (uint64_t k : keys[t]) cursor[t][k]++;
+    });
+    vector<uint32_t> start(groups + 1, 0);
+    for (size_t g = 0; g < groups; ++g) {
+        uint32_t offset = start[g];
+        for (unsigned t = 0; t < threads; ++t) {
+            uint32_t n = cursor[t][g];
+            cursor[t][g] = offset;
+            offset += n;
+        }
+        start[g + 1] = offset;
+    }
+
+    // Scatter fares (and airlines, for the share) so each group is contiguous
+    vector<int32_t> fares(start[groups]);
+    vector<uint16_t> fare_airlines(start[groups]);
+    parallel_for(threads, threads, [&](unsigned, size_t lo, size_t hi) {
+        for (size_t t = lo; t < hi; ++t) {
+            for (size_t i = 0; i < rows[t].size(); ++i) {
+                uint32_t pos = cursor[t][keys[t][i]]++;
+                fares[pos] = c.price[rows[t][i]];
+                fare_airlines[pos] = c.airline[rows[t][i]];
+            }
+        }
+    });
+
+    vector<uint32_t> present;
+    for (size_t g = 0; g < groups; ++g) if (start[g + 1] > start[g]) present.push_back((uint32_t)g);
+
+    vector<GroupStats> out(present.size());
+    parallel_for(present.size(), threads, [&](unsigned, size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            uint32_t g = present[i];
+            out[i].parts = layout.decode(g);
+            finish_group(out[i], fares.data() + start[g], fare_airlines.data() + start[g],
+                         start[g + 1] - start[g], c.airlines.size());
+        }
+    });
+    return out;
+}
+
+vector<GroupStats> group_hashed(const FlightColumns& c, const KeyLayout& layout,
+                                const vector<vector<uint32_t>>& rows, const vector<vector<uint64_t>>& keys) {
+    unordered_map<uint64_t, pair<vector<int32_t>, vector<uint16_t>>> groups;
+    for (size_t t = 0; t < rows.size(); ++t) {
+        for (size_t i = 0; i < rows[t].size(); ++i) {
+            auto& g = groups[keys[t][i]];
+            g.first.push_back(c.price[rows[t][i]]);
+            g.second.push_back(c.airline[rows[t][i]]);
+        }
+    }
+    vector<GroupStats> out;
+    for (auto& entry : groups) {
+        GroupStats s;
+        s.parts = layout.decode(entry.first);
+        finish_group(s, entry.second.first.data(), entry.second.second.data(), entry.second.first.size(),
+                     c.airlines.size());
+        out.push_back(move(s));
+    }
+    return out;
+}
+
+} // namespace
+
+json run_analytics(const FlightColumns& c, const AnalyticsQuery& q, unsigned threads) {
+    auto start = chrono::steady_clock::now();
+    json out;
+    out["rows_scanned"] = c.size();
+
+    KeyLayout layout(c, q.group_by);
+    // Keys must fit in 64 bits even on the hashed path
+    if (layout.groups == 0 || layout.radix.size() > 4) {
+        out["error"] = "Too many group_by keys";
+        return out;
+    }
+
+    // Translate filters to ids; an unknown name matches nothing
+    Bounds b;
+    bool empty = false;
+    if (!q.origin.empty() && (b.origin = c.airport_id(q.origin)) < 0) empty = true;
+    if (!q.destination.empty() && (b.destination = c.airport_id(q.destination)) < 0) empty = true;
+    if (!q.airline.empty() && (b.airline = c.airline_id(q.airline)) < 0) empty = true;
+    if (!q.date_from.empty()) b.date_lo = c.date_lower_bound(q.date_from);
+    if (!q.date_to.empty()) b.date_hi = c.date_lower_bound(q.date_to + "~") - 1; // '~' sorts after digits
+    if (q.min_price >= 0) b.price_lo = q.min_price;
+    if (q.max_price >= 0) b.price_hi = q.max_price;
+
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    size_t n_rows = empty ? 0 : c.size();
+    threads = (unsigned)max<size_t>(1, min<size_t>(threads, n_rows / 65536 + 1));
+
+    vector<vector<uint32_t>> rows(threads);
+    vector<vector<uint64_t>> keys(threads);
+    parallel_for(n_rows, threads, [&](unsigned t, size_t lo, size_t hi) {
+        filter_rows(c, b, layout, q.group_by, lo, hi, rows[t], keys[t]);
+    });
+
+    size_t matched = 0;
+    for (const auto& r : rows) matched += r.size();
+
+    vector<GroupStats> groups = layout.groups <= DENSE_GROUP_LIMIT ? group_dense(c, layout, rows, keys, threads)
+                                                                   : group_hashed(c, layout, rows, keys);
+
+    json result = json::array();
+    for (const auto& g : groups) {
+        json row;
+        size_t i = 0;
+        for (auto k : q.group_by) {
+            switch (k) {
+                case AnalyticsQuery::ROUTE:
+                    row["origin"] = c.airports[g.parts[i++]];
+                    row["destination"] = c.airports[g.parts[i++]];
+                    break;
+                case AnalyticsQuery::ORIGIN: row["origin"] = c.airports[g.parts[i++]]; break;
+                case AnalyticsQuery::DESTINATION: row["destination"] = c.airports[g.parts[i++]]; break;
+                case AnalyticsQuery::AIRLINE: row["airline"] = c.airlines[g.parts[i++]]; break;
+                case AnalyticsQuery::DATE: row["date"] = c.dates[g.parts[i++]]; break;
+            }
+        }
+
+        row["count"] = g.count;
+        row["min_price"] = g.min;
+        row["median_price"] = g.median;
+        row["max_price"] = g.max;
+        row["avg_price"] = (double)g.sum / g.count;
+
+        json share = json::object();
+        for (size_t a = 0; a < g.airline_counts.size(); ++a) {
+            if (g.airline_counts[a]) share[c.airlines[a]] = (double)g.airline_counts[a] / g.count;
+        }
+        row["airline_share"] = share;
+        result.push_back(row);
+    }
+
+    out["rows_matched"] = matched;
+    out["groups"] = result;
+    out["threads"] = threads;
+    out["elapsed_ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return out;
+}
@@ -0,0 +1,57 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Column-oriented copy of the flight table for aggregate queries. Strings
+// are interned into small integer ids so scans touch only packed int arrays.
+// Date ids follow calendar order, so date ranges are id ranges. Each string
+// column holds up to 65536 distinct values.
+class FlightColumns {
+public:
+    void add(const std::string& origin, const std::string& destination, const std::string& airline,
+             const std::string& date, int price);
+    void finish(); // Call once after the last add()
+
+    static FlightColumns from_json(const json& flights);
+
+    size_t size() const { return price.size(); }
+
+    std::vector<int32_t> price;
+    std::vector<uint16_t> origin, destination, airline, date;
+
+    std::vector<std::string> airports, airlines, dates; // id -> name
+
+    int airport_id(const std::string& code) const;      // -1 if unknown
+    int airline_id(const std::string& name) const;
+    int date_lower_bound(const std::string& date) const; // First date id >= date
+
+private:
+    std::unordered_map<std::string, uint16_t> airport_ids, airline_ids, date_ids;
+    static uint16_t intern(std::unordered_map<std::string, uint16_t>& ids, std::vector<std::string>& names,
+                           const std::string& key);
+};
+
+struct AnalyticsQuery {
+    enum GroupKey { ROUTE, ORIGIN, DESTINATION, AIRLINE, DATE };
+    std::vector<GroupKey> group_by;     // Empty = one group for everything
+
+    std::string origin, destination, airline; // Equality filters (empty = any)
+    std::string date_from, date_to;           // Inclusive range (empty = open)
+    int min_price = -1, max_price = -1;       // Inclusive range (-1 = open)
+};
+
+// Parses "route,airline" style lists; returns false on an unknown key
+bool parse_group_keys(const std::string& csv, std::vector<AnalyticsQuery::GroupKey>& out);
+
+// Filters and groups the columns on `threads` workers (0 = all cores) and
+// returns per-group count, min / median / max / avg fare and airline share
+json run_analytics(const FlightColumns& cols, const AnalyticsQuery& q, unsigned threads = 0);
+
+#endif
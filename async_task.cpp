@@ -0,0 +1,106 @@
+#include "async_task.h"
+#include <algorithm>
+
+using namespace std;
+
+// ==========================================
+// EXECUTOR
+// ==========================================
+
+Executor::Executor(string name, unsigned threads) : label(move(name)) {
+    for (unsigned i = 0; i < max(1u, threads); ++i) workers.emplace_back([this] { run(); });
+}
+
+Executor::~Executor() {
+    shutdown();
+}
+
+void Executor::post(coroutine_handle<> h) {
+    {
+        unique_lock<mutex> lock(mtx);
+        if (stopping) { // The workers may be gone already
+            resumed++;
+            lock.unlock();
+            h.resume();
+            return;
+        }
+        queue.push_back(h);
+        max_queued = max(max_queued, queue.size());
+    }
+    wake.notify_one();
+}
+
+void Executor::run() {
+    unique_lock<mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) return; // Stopping and drained
+        coroutine_handle<> h = queue.front();
+        queue.pop_front();
+        resumed++;
+        lock.unlock();
+        h.resume();
+        lock.lock();
+    }
+}
+
+void Executor::shutdown() {
+    {
+        lock_guard<mutex> lock(mtx);
+        if (stopping) return;
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) t.join();
+    }
+}
+
+Executor::Stats Executor::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {workers.size(), queue.size(), max_queued, resumed};
+}
+
+// ==========================================
+// ASYNC MUTEX
+// ==========================================
+
+bool AsyncMutex::try_lock() {
+    lock_guard<mutex> lock(mtx);
+    if (locked) return false;
+    locked = true;
+    acquired++;
+    return true;
+}
+
+bool AsyncMutex::enqueue(coroutine_handle<> h, Executor& resume_on) {
+    lock_guard<mutex> lock(mtx);
+    acquired++;
+    if (!locked) { // Released since try_lock()
+        locked = true;
+        return false;
+    }
+    contended++;
+    waiters.push_back({h, &resume_on});
+    max_waiting = max(max_waiting, waiters.size());
+    return true;
+}
+
+void AsyncMutex::unlock() {
+    pair<coroutine_handle<>, Executor*> next;
+    {
+        lock_guard<mutex> lock(mtx);
+        if (waiters.empty()) {
+            locked = false;
+            return;
+        }
+        next = waiters.front(); // Ownership passes straight to it; `locked` stays set
+        waiters.pop_front();
+    }
+    next.second->post(next.first);
+}
+
+AsyncMutex::Stats AsyncMutex::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {waiters.size(), max_waiting, acquired, contended};
+}
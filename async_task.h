@@ -0,0 +1,117 @@
+#ifndef ASYNC_TASK_H
+#define ASYNC_TASK_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Return type of a detached coroutine (a request handler): it runs on the
+// caller's thread up to its first co_await and frees its frame when it
+// finishes. Nobody waits on it, so it must deliver its own result (answer
+// its response) and catch its own exceptions; one that escapes terminates
+// the process, as it would from a std::thread.
+struct AsyncTask {
+    struct promise_type {
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// A fixed pool of threads that resume coroutines in FIFO order.
+// `co_await pool.schedule()` moves the rest of a coroutine onto the pool.
+class Executor {
+public:
+    Executor(std::string name, unsigned threads);
+    ~Executor(); // shutdown()
+
+    struct Schedule {
+        Executor& pool;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { pool.post(h); }
+        void await_resume() const noexcept {}
+    };
+    Schedule schedule() { return {*this}; }
+
+    void post(std::coroutine_handle<> h);
+    void shutdown(); // Runs what is queued, then joins; later posts resume on the caller
+
+    struct Stats {
+        size_t threads, queued, max_queued;
+        uint64_t resumed;
+    };
+    Stats stats();
+    const std::string& name() const { return label; }
+
+private:
+    void run();
+
+    const std::string label;
+    std::mutex mtx;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> queue;
+    std::vector<std::thread> workers;
+    size_t max_queued = 0;
+    uint64_t resumed = 0;
+    bool stopping = false;
+};
+
+// A mutex for coroutines: `auto guard = co_await m.lock(pool)` suspends
+// while another holder has it, without blocking a thread, and resumes on
+// `pool` once ownership is handed over (FIFO). The guard unlocks when it
+// is destroyed; never co_await while holding one.
+class AsyncMutex {
+public:
+    class Guard {
+    public:
+        explicit Guard(AsyncMutex* m) : owner(m) {}
+        Guard(Guard&& other) noexcept : owner(std::exchange(other.owner, nullptr)) {}
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+        ~Guard() { unlock(); }
+        void unlock() {
+            if (owner) std::exchange(owner, nullptr)->unlock();
+        }
+
+    private:
+        AsyncMutex* owner;
+    };
+
+    struct Lock {
+        AsyncMutex& m;
+        Executor& resume_on;
+        bool await_ready() { return m.try_lock(); }
+        bool await_suspend(std::coroutine_handle<> h) { return m.enqueue(h, resume_on); }
+        Guard await_resume() noexcept { return Guard(&m); }
+    };
+    Lock lock(Executor& resume_on) { return {*this, resume_on}; }
+
+    struct Stats {
+        size_t waiting, max_waiting;
+        uint64_t acquired, contended;
+    };
+    Stats stats();
+
+private:
+    bool try_lock();
+    bool enqueue(std::coroutine_handle<> h, Executor& resume_on); // false: got it after all
+    void unlock();
+
+    std::mutex mtx;
+    bool locked = false;
+    std::deque<std::pair<std::coroutine_handle<>, Executor*>> waiters;
+    size_t max_waiting = 0;
+    uint64_t acquired = 0, contended = 0;
+};
+
+#endif
@@ -1,166 +1,15 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <queue>
-#include <map>
 #include <algorithm>
 #include <iomanip>
+#include "flight_network.h"
 
 using namespace std;
+using namespace network;
 
 // ==========================================
-// 1. Data Structures
-// ==========================================
-
-// Represents a single scheduled flight (The Edge)
-struct Flight {
-    string id;          // Flight Number (e.g., "BA101")
-    string from;        // Origin
-    string to;          // Destination
-    int cost;           // Price in USD
-    int depTime;        // Departure Time (Minutes from T=0)
-    int arrTime;        // Arrival Time (Minutes from T=0)
-};
-
-// Represents a complete Path found (for returning results)
-struct PathResult {
-    int totalCost;
-    int arrivalTime;
-    vector<string> routeDescription; // List of flight IDs and segments
-};
-
-// Represents the State in the Priority Queue
-struct SearchState {
-    int currentCost;            // Accumulator: Total Money Spent
-    string currentAirport;      // Where are we?
-    int arrivalTime;            // When did we arrive here?
-    
-    vector<string> pathHistory; // For tracking the route
-    vector<string> visitedNodes; // To prevent cycles (A->B->A)
-
-    // PRIORITY QUEUE SORTING LOGIC:
-    // We want the LOWEST cost to be at the TOP.
-    // In C++ std::priority_queue, 'true' means "put lower in hierarchy".
-    // So for a Min-Heap, we need greater-than logic.
-    bool operator>(const SearchState& other) const {
-        return currentCost > other.currentCost;
-    }
-};
-
-// ==========================================
-// 2. The Flight Graph Class
-// ==========================================
-
-class FlightNetwork {
-public:
-    // Adjacency List: Map Airport Code -> List of Flights leaving it
-    map<string, vector<Flight>> adjList;
-
-    void addFlight(string id, string u, string v, int cost, int dep, int duration) {
-        Flight f;
-        f.id = id;
-        f.from = u;
-        f.to = v;
-        f.cost = cost;
-        f.depTime = dep;
-        f.arrTime = dep + duration;
-        adjList[u].push_back(f);
-    }
-
-    // ---------------------------------------------------------
-    // THE ALGORITHM: Find Top K Shortest Paths (By Price)
-    // ---------------------------------------------------------
-    vector<PathResult> getTopKPaths(string startNode, string endNode, int k, int minLayoverMins) {
-        
-        vector<PathResult> results;
-        
-        // 1. Priority Queue (Min-Heap based on Cost)
-        priority_queue<SearchState, vector<SearchState>, greater<SearchState>> pq;
-
-        // 2. Initial State
-        // Cost 0, At StartNode, Arrival Time -1 (indicates start of journey)
-        pq.push({0, startNode, -1, {}, {startNode}});
-
-        // 3. Counter for how many times we visited specific nodes
-        // (Optimization: Stop processing a node if we've found K+ paths through it already)
-        map<string, int> visitCounts;
-
-        while (!pq.empty()) {
-            // Pop the cheapest option
-            SearchState current = pq.top();
-            pq.pop();
-
-            string u = current.currentAirport;
-
-            // --- GOAL CHECK ---
-            if (u == endNode) {
-                // Construct Result
-                PathResult res;
-                res.totalCost = current.currentCost;
-                res.arrivalTime = current.arrivalTime;
-                res.routeDescription = current.pathHistory;
-                results.push_back(res);
-
-                // If we found K paths, we are done
-                if (results.size() >= k) return results;
-                
-                // Otherwise, continue to find the next best one
-                continue; 
-            }
-
-            // --- PRUNING ---
-            // If we have extracted this airport from PQ more than K+2 times,
-            // it's unlikely to yield a 'top K' result better than what we have.
-            visitCounts[u]++;
-            if (visitCounts[u] > k + 5) continue; 
-
-            // --- EXPAND NEIGHBORS ---
-            if (adjList.find(u) != adjList.end()) {
-                for (const auto& flight : adjList[u]) {
-                    
-                    // 1. CYCLE CHECK: Don't go back to an airport we are already in
-                    bool cycleDetected = false;
-                    for (const string& visited : current.visitedNodes) {
-                        if (visited == flight.to) { cycleDetected = true; break; }
-                    }
-                    if (cycleDetected) continue;
-
-                    // 2. TIME CONSTRAINT:
-                    // Valid if (First Flight) OR (Flight Departs >= Arrival + Layover)
-                    bool timeValid = false;
-                    if (current.arrivalTime == -1) {
-                        timeValid = true; // First flight of the trip
-                    } else {
-                        if (flight.depTime >= current.arrivalTime + minLayoverMins) {
-                            timeValid = true;
-                        }
-                    }
-
-                    if (timeValid) {
-                        SearchState nextState;
-                        nextState.currentCost = current.currentCost + flight.cost;
-                        nextState.currentAirport = flight.to;
-                        nextState.arrivalTime = flight.arrTime;
-                        
-                        // Copy History
-                        nextState.pathHistory = current.pathHistory;
-                        nextState.pathHistory.push_back(flight.id + " (" + u + "->" + flight.to + ")");
-                        
-                        nextState.visitedNodes = current.visitedNodes;
-                        nextState.visitedNodes.push_back(flight.to);
-
-                        pq.push(nextState);
-                    }
-                }
-            }
-        }
-
-        return results;
-    }
-};
-
-// ==========================================
-// 3. Helper Functions (Time Formatting)
+// 1. Helper Functions (Time Formatting)
 // ==========================================
 
 string formatTime(int totalMins) {
@@ -176,7 +25,7 @@ string formatTime(int totalMins) {
 }
 
 // ==========================================
-// 4. Main Execution
+// 2. Main Execution
 // ==========================================
 
 int main() {
@@ -0,0 +1,218 @@
+#ifndef FLIGHT_NETWORK_H
+#define FLIGHT_NETWORK_H
+
+#include <vector>
+#include <string>
+#include <queue>
+#include <map>
+
+// The price-ordered top-K search over absolute times, shared by the demo
+// in algo.cpp and bench/route_diff.cpp. Kept in a namespace because
+// Models.h has its own Flight.
+namespace network {
+
+using std::string;
+using std::vector;
+using std::map;
+using std::priority_queue;
+using std::greater;
+
+// ==========================================
+// 1. Data Structures
+// ==========================================
+
+// Represents a single scheduled flight (The Edge)
+struct Flight {
+    string id;          // Flight Number (e.g., "BA101")
+    string from;        // Origin
+    string to;          // Destination
+    int cost;           // Price in USD
+    int depTime;        // Departure Time (Minutes from T=0)
+    int arrTime;        // Arrival Time (Minutes from T=0)
+};
+
+// Represents a complete Path found (for returning results)
+struct PathResult {
+    int totalCost;
+    int arrivalTime;
+    vector<string> routeDescription; // List of flight IDs and segments
+};
+
+// Represents the State in the Priority Queue
+struct SearchState {
+    int currentCost;            // Accumulator: Total Money Spent
+    string currentAirport;      // Where are we?
+    int arrivalTime;            // When did we arrive here?
+    
+    vector<string> pathHistory; // For tracking the route
+    vector<string> visitedNodes; // To prevent cycles (A->B->A)
+
+    // PRIORITY QUEUE SORTING LOGIC:
+    // We want the LOWEST cost to be at the TOP.
+    // In C++ std::priority_queue, 'true' means "put lower in hierarchy".
+    // So for a Min-Heap, we need greater-than logic.
+    bool operator>(const SearchState& other) const {
+        return currentCost > other.currentCost;
+    }
+};
+
+// Summary of a queued state, kept per airport for dominance checks
+struct Label {
+    int cost;
+    int arrivalTime;
+    int hops;
+    vector<string> visitedNodes; // The state's path so far
+
+    // At least as cheap, as early and as short as the other label, and
+    // visited no airport the other did not (a path may not revisit one, so
+    // otherwise the other may still reach places this one cannot)
+    bool dominates(const Label& other) const {
+        if (cost > other.cost || arrivalTime > other.arrivalTime || hops > other.hops) return false;
+        for (const string& node : visitedNodes) {
+            bool found = false;
+            for (const string& seen : other.visitedNodes) {
+                if (seen == node) { found = true; break; }
+            }
+            if (!found) return false;
+        }
+        return true;
+    }
+};
+
+// Work done by one search (optional out-parameter of getTopKPaths)
+struct SearchCounts {
+    size_t pushed = 0; // States queued
+    size_t popped = 0; // States taken off the queue
+    size_t pruned = 0; // States dropped by label dominance
+};
+
+// ==========================================
+// 2. The Flight Graph Class
+// ==========================================
+
+class FlightNetwork {
+public:
+    // Adjacency List: Map Airport Code -> List of Flights leaving it
+    map<string, vector<Flight>> adjList;
+
+    void addFlight(string id, string u, string v, int cost, int dep, int duration) {
+        Flight f;
+        f.id = id;
+        f.from = u;
+        f.to = v;
+        f.cost = cost;
+        f.depTime = dep;
+        f.arrTime = dep + duration;
+        adjList[u].push_back(f);
+    }
+
+    // ---------------------------------------------------------
+    // THE ALGORITHM: Find Top K Shortest Paths (By Price)
+    // ---------------------------------------------------------
+    vector<PathResult> getTopKPaths(string startNode, string endNode, int k, int minLayoverMins,
+                                    SearchCounts* counts = nullptr) {
+        
+        vector<PathResult> results;
+        SearchCounts localCounts;
+        SearchCounts& work = counts ? *counts : localCounts;
+        
+        // 1. Priority Queue (Min-Heap based on Cost)
+        priority_queue<SearchState, vector<SearchState>, greater<SearchState>> pq;
+
+        // 2. Initial State
+        // Cost 0, At StartNode, Arrival Time -1 (indicates start of journey)
+        pq.push({0, startNode, -1, {}, {startNode}});
+        work.pushed++;
+
+        // 3. Label buckets: for every airport, the (cost, arrival, hops, visited
+        // airports) of the states we have already queued there.
+        // (Optimization: a new state that K queued states beat on ALL three
+        // numbers, having visited nothing it has not, can never be in the top
+        // K, because each of those K can take any onward flight it could
+        // take, for less money. So we never push it.)
+        map<string, vector<Label>> buckets;
+
+        while (!pq.empty()) {
+            // Pop the cheapest option
+            SearchState current = pq.top();
+            pq.pop();
+            work.popped++;
+
+            string u = current.currentAirport;
+
+            // --- GOAL CHECK ---
+            if (u == endNode) {
+                // Construct Result
+                PathResult res;
+                res.totalCost = current.currentCost;
+                res.arrivalTime = current.arrivalTime;
+                res.routeDescription = current.pathHistory;
+                results.push_back(res);
+
+                // If we found K paths, we are done
+                if (results.size() >= (size_t)k) return results;
+                
+                // Otherwise, continue to find the next best one
+                continue; 
+            }
+
+            // --- EXPAND NEIGHBORS ---
+            if (adjList.find(u) != adjList.end()) {
+                for (const auto& flight : adjList[u]) {
+                    
+                    // 1. CYCLE CHECK: Don't go back to an airport we are already in
+                    bool cycleDetected = false;
+                    for (const string& visited : current.visitedNodes) {
+                        if (visited == flight.to) { cycleDetected = true; break; }
+                    }
+                    if (cycleDetected) continue;
+
+                    // 2. TIME CONSTRAINT:
+                    // Valid if (First Flight) OR (Flight Departs >= Arrival + Layover)
+                    bool timeValid = false;
+                    if (current.arrivalTime == -1) {
+                        timeValid = true; // First flight of the trip
+                    } else {
+                        if (flight.depTime >= current.arrivalTime + minLayoverMins) {
+                            timeValid = true;
+                        }
+                    }
+
+                    if (timeValid) {
+                        SearchState nextState;
+                        nextState.currentCost = current.currentCost + flight.cost;
+                        nextState.currentAirport = flight.to;
+                        nextState.arrivalTime = flight.arrTime;
+                        
+                        // Copy History
+                        nextState.pathHistory = current.pathHistory;
+                        nextState.pathHistory.push_back(flight.id + " (" + u + "->" + flight.to + ")");
+                        
+                        nextState.visitedNodes = current.visitedNodes;
+                        nextState.visitedNodes.push_back(flight.to);
+
+                        // --- PRUNING (Label Dominance) ---
+                        Label label = {nextState.currentCost, nextState.arrivalTime, (int)nextState.pathHistory.size(),
+                                       nextState.visitedNodes};
+                        vector<Label>& bucket = buckets[flight.to];
+                        int dominatedBy = 0;
+                        for (const Label& other : bucket) {
+                            if (other.dominates(label)) dominatedBy++;
+                        }
+                        if (dominatedBy >= k) { work.pruned++; continue; }
+
+                        bucket.push_back(label);
+                        pq.push(nextState);
+                        work.pushed++;
+                    }
+                }
+            }
+        }
+
+        return results;
+    }
+};
+
+} // namespace network
+
+#endif
@@ -0,0 +1,79 @@
+// ==========================================
+// ANALYTICS BENCHMARK: group-by scans on synthetic flights
+// ==========================================
+// Builds a synthetic flight table (1M rows by default) directly in columnar
+// form and times run_analytics for several group-by shapes and thread counts.
+//
+// Usage: analytics_bench [rows] [repeats]
+
+#include "analytics.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    size_t rows = argc > 1 ? stoull(argv[1]) : 1000000;
+    int repeats = argc > 2 ? stoi(argv[2]) : 5;
+
+    mt19937 rng(7);
+    vector<string> airports, dates;
+    for (int i = 0; i < 50; ++i) airports.push_back(string(1, 'A' + i / 26) + string(1, 'A' + i % 26) + "X");
+    for (int d = 1; d <= 30; ++d) dates.push_back("2025-12-" + string(d < 10 ? "0" : "") + to_string(d));
+    const string airlines[] = {"IndiGo", "Air India", "Vistara", "SpiceJet", "Akasa Air"};
+
+    auto t0 = chrono::steady_clock::now();
+    FlightColumns cols;
+    for (size_t i = 0; i < rows; ++i) {
+        size_t o = rng() % airports.size(), d = (o + 1 + rng() % (airports.size() - 1)) % airports.size();
+        cols.add(airports[o], airports[d], airlines[rng() % 5], dates[rng() % dates.size()], 3000 + (int)(rng() % 5000));
+    }
+    cols.finish();
+    double build_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    cout << "rows=" << rows << " build_ms=" << fixed << setprecision(1) << build_ms << "\n";
+
+    struct Case {
+        const char* name;
+        AnalyticsQuery q;
+    };
+    vector<Case> cases(4);
+    cases[0].name = "route";
+    cases[0].q.group_by = {AnalyticsQuery::ROUTE};
+    cases[1].name = "origin,airline";
+    cases[1].q.group_by = {AnalyticsQuery::ORIGIN, AnalyticsQuery::AIRLINE};
+    cases[2].name = "route,date (origin filter)";
+    cases[2].q.group_by = {AnalyticsQuery::ROUTE, AnalyticsQuery::DATE};
+    cases[2].q.origin = airports[0];
+    cases[3].name = "date (price + date range)";
+    cases[3].q.group_by = {AnalyticsQuery::DATE};
+    cases[3].q.min_price = 4000;
+    cases[3].q.max_price = 6000;
+    cases[3].q.date_from = "2025-12-05";
+    cases[3].q.date_to = "2025-12-20";
+
+    unsigned hw = max(1u, thread::hardware_concurrency());
+    vector<unsigned> thread_counts = {1};
+    for (unsigned t = 2; t <= hw; t *= 2) thread_counts.push_back(t);
+    if (thread_counts.back() != hw) thread_counts.push_back(hw);
+
+    cout << setprecision(2);
+    for (const auto& c : cases) {
+        for (unsigned t : thread_counts) {
+            double best = 1e18;
+            json out;
+            for (int r = 0; r < repeats; ++r) {
+                auto s = chrono::steady_clock::now();
+                out = run_analytics(cols, c.q, t);
+                best = min(best, chrono::duration<double, milli>(chrono::steady_clock::now() - s).count());
+            }
+            double mrows = rows / (best / 1000.0) / 1e6;
+            cout << setw(28) << left << c.name << right << " threads=" << setw(2) << t << "  best_ms=" << setw(8) << best
+                 << "  Mrows/s=" << setw(8) << mrows << "  groups=" << out["groups"].size()
+                 << "  matched=" << out["rows_matched"] << "\n";
+        }
+    }
+    return 0;
+}
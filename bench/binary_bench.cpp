@@ -0,0 +1,181 @@
+// ==========================================
+// BINARY PROTOCOL BENCHMARK: HTTP/JSON vs binary search
+// ==========================================
+// Runs the same sampled searches against a running server_app over
+// /api/search (keep-alive HTTP, responses parsed with nlohmann::json) and
+// over the binary protocol (BinaryClient, responses decoded into structs),
+// and reports req/s, latency and bytes per response for each.
+//
+// Each query gets a distinct, non-binding max_price so the HTTP response
+// cache never answers it; run the server with FLIGHT_PREFETCH=0 so
+// speculative searches do not compete with the HTTP side only.
+//
+// Usage: binary_bench [http_port] [binary_port] [queries] [connections]
+
+#include "binary_client.h"
+#include "metrics.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using json = nlohmann::json;
+using bench_clock = chrono::steady_clock;
+
+static int connect_http(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// GET on a keep-alive connection; the response body, or false
+static bool http_get(int fd, const string& target, string& buf, string& body) {
+    string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+
+    char chunk[16 * 1024];
+    size_t head_end, length = 0;
+    while ((head_end = buf.find("\r\n\r\n")) == string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    for (size_t pos = buf.find("\r\n") + 2; pos < head_end;) {
+        size_t end = buf.find("\r\n", pos);
+        string line = buf.substr(pos, end - pos);
+        if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) length = stoul(line.substr(15));
+        pos = end + 2;
+    }
+    while (buf.size() < head_end + 4 + length) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    body = buf.substr(head_end + 4, length);
+    buf.erase(0, head_end + 4 + length);
+    return true;
+}
+
+struct Side {
+    LatencyHistogram latency;
+    atomic<uint64_t> done{0}, failed{0}, bytes{0}, routes{0};
+    double seconds = 0;
+};
+
+static void report(const string& name, const Side& s) {
+    uint64_t n = max<uint64_t>(1, s.done.load());
+    cout << left << setw(8) << name << right << setw(8) << s.done << setw(8) << s.failed
+         << setw(10) << (s.seconds > 0 ? s.done / s.seconds : 0.0)
+         << setw(9) << s.latency.percentile_ms(0.50) << setw(9) << s.latency.percentile_ms(0.99)
+         << setw(10) << s.bytes / n << setw(8) << s.routes / n << "\n";
+}
+
+int main(int argc, char** argv) {
+    int http_port = argc > 1 ? stoi(argv[1]) : 8080;
+    int binary_port = argc > 2 ? stoi(argv[2]) : 9090;
+    int n_queries = argc > 3 ? stoi(argv[3]) : 2000;
+    int connections = argc > 4 ? stoi(argv[4]) : 4;
+
+    // Airport codes for the sample
+    vector<string> codes;
+    {
+        int fd = connect_http(http_port);
+        string buf, body;
+        if (fd < 0 || !http_get(fd, "/api/airports", buf, body)) {
+            cerr << "Cannot reach the HTTP port " << http_port << endl;
+            return 1;
+        }
+        close(fd);
+        for (const auto& a : json::parse(body)) codes.push_back(a["code"]);
+    }
+    if (codes.size() < 2) {
+        cerr << "Need at least two airports" << endl;
+        return 1;
+    }
+
+    mt19937 rng(42);
+    vector<WireSearch> queries;
+    for (int i = 0; i < n_queries; ++i) {
+        WireSearch q;
+        string src = codes[rng() % codes.size()], dst;
+        do { dst = codes[rng() % codes.size()]; } while (dst == src);
+        int day = 1 + (int)(rng() % 10);
+        q.srcs = {src};
+        q.dsts = {dst};
+        q.date = "2025-12-" + string(day < 10 ? "0" : "") + to_string(day);
+        q.max_price = 100000000 + i; // Distinct, never binding
+        queries.push_back(q);
+    }
+
+    Side http, binary;
+
+    auto run = [&](Side& side, bool use_binary) {
+        auto start = bench_clock::now();
+        vector<thread> workers;
+        for (int c = 0; c < connections; ++c) {
+            workers.emplace_back([&, c] {
+                BinaryClient client;
+                int fd = -1;
+                string buf, body;
+                if (use_binary ? !client.connect_tcp("127.0.0.1", binary_port) : (fd = connect_http(http_port)) < 0) {
+                    side.failed++;
+                    return;
+                }
+                for (int i = c; i < n_queries; i += connections) {
+                    const WireSearch& q = queries[i];
+                    auto t0 = bench_clock::now();
+                    size_t n_routes = 0, n_bytes = 0;
+                    if (use_binary) {
+                        WireResult result;
+                        if (!client.search(q, result)) { side.failed++; break; }
+                        n_routes = result.routes.size();
+                        n_bytes = client.last_reply_bytes();
+                    } else {
+                        string target = "/api/search?from=" + q.srcs[0] + "&to=" + q.dsts[0] + "&date=" + q.date +
+                                        "&max_price=" + to_string(q.max_price);
+                        if (!http_get(fd, target, buf, body)) { side.failed++; break; }
+                        n_routes = json::parse(body).size();
+                        n_bytes = body.size();
+                    }
+                    side.latency.record_us((uint64_t)chrono::duration_cast<chrono::microseconds>(bench_clock::now() - t0).count());
+                    side.done++;
+                    side.routes += n_routes;
+                    side.bytes += n_bytes;
+                }
+                if (fd >= 0) close(fd);
+            });
+        }
+        for (auto& w : workers) w.join();
+        side.seconds = chrono::duration<double>(bench_clock::now() - start).count();
+    };
+
+    run(http, false);
+    run(binary, true);
+
+    cout << fixed << setprecision(3);
+    cout << "queries=" << n_queries << " connections=" << connections << "\n";
+    cout << left << setw(8) << "path" << right << setw(8) << "done" << setw(8) << "failed" << setw(10) << "req/s"
+         << setw(9) << "p50_ms" << setw(9) << "p99_ms" << setw(10) << "bytes" << setw(8) << "routes" << "\n";
+    report("http", http);
+    report("binary", binary);
+    return 0;
+}
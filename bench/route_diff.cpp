@@ -0,0 +1,583 @@
+// ==========================================
+// ROUTE ENGINE DIFFERENTIAL HARNESS
+// ==========================================
+// Generates random small networks and queries (after a few fixed
+// regression cases), runs every route engine on them next to a brute-force
+// enumerator of all simple itineraries, and reports per engine how often
+// its answer differs from the reference, recall (for approximate engines),
+// latency and states explored. Exact engines must return the reference's K
+// best costs; every returned route is also replayed against its rules.
+// Exits with status 1 on any mismatch.
+//
+// Two rule sets are covered:
+//   jsondb   JsonDB::find_*_routes: one date, clock times, ranked by total
+//            minutes (block time plus 60 per connection), SearchConstraints
+//   network  FlightNetwork (backend/flight_network.h): absolute times, a
+//            minimum layover, ranked by price
+// A new engine is one more entry in make_engines() checked against either.
+//
+// Usage: route_diff [cases] [queries_per_case] [seed] [airports] [flights_per_day]
+// Case i uses seed + i, so "route_diff 1 Q <case seed>" replays one case.
+
+#include "jsondb.h"
+#include "backend/flight_network.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using bench_clock = chrono::steady_clock;
+
+static const int DAYS = 2;                   // Network rules see both days, JsonDB one at a time
+static const size_t REFERENCE_LIMIT = 2000000; // DFS states per query before the case is skipped
+static const size_t SHOWN_FAILURES = 5;
+
+// ==========================================
+// RANDOM NETWORKS
+// ==========================================
+
+struct GenFlight {
+    string id, from, to, airline;
+    int day, dep, duration, price; // dep: clock minutes on `day`
+    bool cancelled;
+    int arr_clock() const { return (dep + duration) % 1440; }
+};
+
+struct Query {
+    vector<string> srcs, dsts;
+    int day = 0;
+    int k = 3;
+    SearchConstraints constraints; // jsondb rules
+    int min_layover = 0;           // network rules (single source and destination)
+};
+
+static string date_of(int day) { return "2025-12-0" + to_string(day + 1); }
+
+static string clock_str(int minutes) {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%02d:%02d", minutes / 60 % 24, minutes % 60);
+    return buf;
+}
+
+// One network with a JsonDB and a FlightNetwork loaded from it
+struct Case {
+    uint64_t seed;
+    vector<string> airports, airlines;
+    vector<GenFlight> flights;
+    unordered_map<string, const GenFlight*> by_id;
+    string db_path;
+    unique_ptr<JsonDB> db;
+    network::FlightNetwork net;
+
+    // A hand-built network (see fixed_cases())
+    Case(uint64_t case_seed, vector<string> codes, vector<GenFlight> legs)
+        : seed(case_seed), airports(move(codes)), airlines({"Alpha"}), flights(move(legs)) {
+        load();
+    }
+
+    Case(uint64_t case_seed, int n_airports, int flights_per_day) : seed(case_seed) {
+        mt19937_64 rng(seed);
+        airlines = {"Alpha", "Beta", "Gamma"};
+        for (int i = 0; i < n_airports; ++i) {
+            airports.push_back(string("Q") + (char)('A' + i / 26) + (char)('A' + i % 26));
+        }
+        for (int day = 0; day < DAYS; ++day) {
+            for (int i = 0; i < flights_per_day; ++i) {
+                GenFlight f;
+                f.id = "RD" + to_string(flights.size());
+                f.from = airports[rng() % airports.size()];
+                do { f.to = airports[rng() % airports.size()]; } while (f.to == f.from);
+                f.airline = airlines[rng() % airlines.size()];
+                f.day = day;
+                f.dep = 5 * 60 + (int)(rng() % 204) * 5;  // 05:00 to 21:55
+                f.duration = 45 + (int)(rng() % 40) * 5;  // Some land after midnight
+                f.price = 1000 + (int)(rng() % 80) * 100;
+                f.cancelled = rng() % 20 == 0;
+                flights.push_back(f);
+            }
+        }
+        load();
+    }
+
+    ~Case() {
+        db.reset();
+        for (const char* suffix : {"", ".prices", ".status"}) remove((db_path + suffix).c_str());
+    }
+
+    void load() {
+        for (const auto& f : flights) by_id[f.id] = &f;
+
+        json data;
+        data["airports"] = json::array();
+        for (size_t i = 0; i < airports.size(); ++i) {
+            data["airports"].push_back(Airport{(int)i + 1, airports[i], airports[i], airports[i],
+                                               10.0 + (double)i, 70.0 + (double)i});
+        }
+        data["flights"] = json::array();
+        for (const auto& f : flights) {
+            Flight fl{f.id, f.airline, f.from, f.to, date_of(f.day), clock_str(f.dep), clock_str(f.arr_clock()),
+                      to_string(f.duration / 60) + "h " + to_string(f.duration % 60) + "m", f.price,
+                      DEFAULT_FLIGHT_CAPACITY};
+            json j = fl;
+            if (f.cancelled) j["status"] = "cancelled";
+            data["flights"].push_back(j);
+
+            if (!f.cancelled) net.addFlight(f.id, f.from, f.to, f.price, f.day * 1440 + f.dep, f.duration);
+        }
+
+        db_path = (filesystem::temp_directory_path() / ("route_diff_" + to_string(seed) + ".json")).string();
+        ofstream(db_path) << data.dump();
+        db.reset(new JsonDB(db_path));
+    }
+
+    Query random_query(mt19937_64& rng) const {
+        Query q;
+        vector<string> shuffled = airports;
+        shuffle(shuffled.begin(), shuffled.end(), rng);
+        bool multi = rng() % 5 == 0 && shuffled.size() >= 4;
+        q.srcs.assign(shuffled.begin(), shuffled.begin() + (multi ? 2 : 1));
+        q.dsts.assign(shuffled.begin() + (multi ? 2 : 1), shuffled.begin() + (multi ? 4 : 2));
+        q.day = (int)(rng() % DAYS);
+        q.k = 1 + (int)(rng() % 6);
+        q.min_layover = (int)(rng() % 4) * 40;
+
+        SearchConstraints& c = q.constraints;
+        if (rng() % 5 < 2) {
+            if (rng() % 3 == 0) c.airlines = {airlines[rng() % 3], airlines[rng() % 3]};
+            if (rng() % 3 == 0) c.max_price = 3000 + (int)(rng() % 120) * 100;
+            if (rng() % 3 == 0) c.max_stops = (int)(rng() % 3);
+            if (rng() % 4 == 0) c.avoid = {shuffled.back()};
+            if (rng() % 4 == 0 && shuffled.size() > 5) c.via = {shuffled[shuffled.size() - 2]};
+        }
+        return q;
+    }
+};
+
+// ==========================================
+// REGRESSION CASES
+// ==========================================
+// Networks that once broke an engine, run before the random ones. Random
+// networks of the default size rarely reproduce them.
+
+struct FixedCase {
+    string name;
+    unique_ptr<Case> net;
+    vector<Query> queries;
+};
+
+static vector<FixedCase> fixed_cases() {
+    vector<FixedCase> cases;
+
+    // A label that has already used up an airport must not prune one that
+    // has not. Both S-B-A labels beat S-C-A at A, but only S-C-A can go
+    // on through B, so k = 2 needs S-C-A-B-D after S-B-D.
+    {
+        auto leg = [](const string& id, const string& from, const string& to, int dep, int duration, int price) {
+            return GenFlight{id, from, to, "Alpha", 0, dep, duration, price, false};
+        };
+        vector<GenFlight> legs = {
+            leg("FX1", "QSS", "QBB", 360, 60, 1000),  leg("FX2", "QBB", "QAA", 480, 60, 1000),
+            leg("FX3", "QBB", "QAA", 480, 60, 1100),  leg("FX4", "QSS", "QCC", 360, 60, 1500),
+            leg("FX5", "QCC", "QAA", 480, 70, 1000),  leg("FX6", "QAA", "QBB", 660, 60, 1000),
+            leg("FX7", "QBB", "QDD", 840, 60, 1000),
+        };
+        FixedCase fc{"revisit_dominance", unique_ptr<Case>(new Case(0, {"QSS", "QBB", "QAA", "QCC", "QDD"}, legs)), {}};
+        Query q;
+        q.srcs = {"QSS"};
+        q.dsts = {"QDD"};
+        q.k = 2;
+        fc.queries.push_back(q);
+        cases.push_back(move(fc));
+    }
+    return cases;
+}
+
+static string describe(const Query& q) {
+    auto join = [](const vector<string>& v) {
+        string s;
+        for (const auto& x : v) s += (s.empty() ? "" : "|") + x;
+        return s;
+    };
+    const SearchConstraints& c = q.constraints;
+    ostringstream out;
+    out << join(q.srcs) << "->" << join(q.dsts) << " " << date_of(q.day) << " k=" << q.k;
+    if (!c.airlines.empty()) out << " airlines=" << join(c.airlines);
+    if (c.max_price >= 0) out << " max_price=" << c.max_price;
+    if (c.max_stops >= 0) out << " max_stops=" << c.max_stops;
+    if (!c.avoid.empty()) out << " avoid=" << join(c.avoid);
+    if (!c.via.empty()) out << " via=" << join(c.via);
+    out << " min_layover=" << q.min_layover;
+    return out.str();
+}
+
+// ==========================================
+// REFERENCE ENUMERATORS
+// ==========================================
+// Depth-first over every simple itinerary, written straight from each
+// engine's documented rules and sharing no code with them.
+
+struct Itinerary {
+    int cost;
+    vector<const GenFlight*> legs;
+};
+
+struct Answer {
+    vector<int> costs;              // In the engine's order
+    vector<vector<string>> routes;  // Flight ids per route
+    vector<int> claimed;            // Cost the engine reported per route
+    size_t states = 0;
+    double us = 0;
+    bool complete = true;           // false: reference gave up (too many itineraries)
+};
+
+static bool contains(const vector<string>& v, const string& x) { return find(v.begin(), v.end(), x) != v.end(); }
+
+// jsondb rules: flights of the query date that are not cancelled; a flight
+// departs no earlier (clock) than the previous one lands; no airport twice
+// and no return to any source; a destination ends the route; constraints
+// hold for the whole route. Cost: block minutes plus 60 per connection.
+static bool jsondb_leg_ok(const Query& q, const GenFlight& f) {
+    const SearchConstraints& c = q.constraints;
+    return f.day == q.day && !f.cancelled && (c.airlines.empty() || contains(c.airlines, f.airline)) &&
+           !contains(c.avoid, f.to);
+}
+
+static bool jsondb_route_ok(const Query& q, const vector<const GenFlight*>& legs, int& cost) {
+    const SearchConstraints& c = q.constraints;
+    if (legs.empty() || !contains(q.srcs, legs[0]->from) || !contains(q.dsts, legs.back()->to)) return false;
+    set<string> seen(q.srcs.begin(), q.srcs.end());
+    int price = 0, prev_arr = -1;
+    cost = 0;
+    for (size_t i = 0; i < legs.size(); ++i) {
+        const GenFlight& f = *legs[i];
+        if (!jsondb_leg_ok(q, f) || (i > 0 && f.from != legs[i - 1]->to)) return false;
+        if (!seen.insert(f.to).second) return false;
+        if (i + 1 < legs.size() && contains(q.dsts, f.to)) return false;
+        if (prev_arr >= 0 && f.dep < prev_arr) return false;
+        prev_arr = f.arr_clock();
+        price += f.price;
+        cost += f.duration + (i > 0 ? 60 : 0);
+    }
+    if (c.max_price >= 0 && price > c.max_price) return false;
+    if (c.max_stops >= 0 && (int)legs.size() - 1 > c.max_stops) return false;
+    for (const auto& v : c.via) {
+        if (contains(q.srcs, v) || contains(q.dsts, v)) continue;
+        if (!any_of(legs.begin(), legs.end(), [&](const GenFlight* f) { return f->to == v; })) return false;
+    }
+    return true;
+}
+
+// network rules: any day; the next flight departs at least min_layover
+// after the previous one lands; no airport twice; the destination ends
+// the route. Cost: total price.
+static bool network_route_ok(const Query& q, const vector<const GenFlight*>& legs, int& cost) {
+    if (legs.empty() || legs[0]->from != q.srcs[0] || legs.back()->to != q.dsts[0]) return false;
+    set<string> seen = {q.srcs[0]};
+    int prev_arr = -1;
+    cost = 0;
+    for (size_t i = 0; i < legs.size(); ++i) {
+        const GenFlight& f = *legs[i];
+        if (f.cancelled || (i > 0 && f.from != legs[i - 1]->to)) return false;
+        if (!seen.insert(f.to).second) return false;
+        if (i + 1 < legs.size() && f.to == q.dsts[0]) return false;
+        int dep = f.day * 1440 + f.dep;
+        if (prev_arr >= 0 && dep < prev_arr + q.min_layover) return false;
+        prev_arr = dep + f.duration;
+        cost += f.price;
+    }
+    return true;
+}
+
+// Enumerates every path the leg filter allows, then keeps those `route_ok`
+// accepts: the two rule sets only differ in those checks
+static Answer enumerate(const Case& c, const Query& q, bool jsondb) {
+    auto t0 = bench_clock::now();
+    Answer ans;
+    unordered_map<string, vector<const GenFlight*>> out;
+    for (const auto& f : c.flights) {
+        if (jsondb ? jsondb_leg_ok(q, f) : !f.cancelled) out[f.from].push_back(&f);
+    }
+    const vector<string>& srcs = jsondb ? q.srcs : vector<string>{q.srcs[0]};
+    const vector<string>& dsts = jsondb ? q.dsts : vector<string>{q.dsts[0]};
+
+    vector<Itinerary> found;
+    vector<const GenFlight*> path;
+    set<string> on_path;
+    function<void(const string&)> dfs = [&](const string& at) {
+        if (++ans.states > REFERENCE_LIMIT) { ans.complete = false; return; }
+        for (const GenFlight* f : out[at]) {
+            if (on_path.count(f->to) || contains(srcs, f->to)) continue;
+            path.push_back(f);
+            int cost;
+            if (contains(dsts, f->to)) {
+                if (jsondb ? jsondb_route_ok(q, path, cost) : network_route_ok(q, path, cost)) found.push_back({cost, path});
+            } else {
+                // Timing is the only rule that prunes a prefix for good
+                bool timing_ok = path.size() < 2 ||
+                    (jsondb ? f->dep >= path[path.size() - 2]->arr_clock()
+                            : f->day * 1440 + f->dep >= path[path.size() - 2]->day * 1440 + path[path.size() - 2]->dep +
+                                                            path[path.size() - 2]->duration + q.min_layover);
+                if (timing_ok) {
+                    on_path.insert(f->to);
+                    dfs(f->to);
+                    on_path.erase(f->to);
+                }
+            }
+            path.pop_back();
+            if (!ans.complete) return;
+        }
+    };
+    for (const auto& s : srcs) {
+        on_path = {s};
+        dfs(s);
+    }
+
+    stable_sort(found.begin(), found.end(), [](const Itinerary& a, const Itinerary& b) { return a.cost < b.cost; });
+    for (size_t i = 0; i < found.size() && (int)i < q.k; ++i) ans.costs.push_back(found[i].cost);
+    ans.us = chrono::duration<double, micro>(bench_clock::now() - t0).count();
+    return ans;
+}
+
+// ==========================================
+// ENGINES
+// ==========================================
+
+enum class Rules { JSONDB, NETWORK };
+
+struct Engine {
+    string name;
+    Rules rules;
+    bool exact; // Must match the reference; otherwise scored by recall
+    function<Answer(Case&, const Query&)> run;
+};
+
+static Answer from_json_routes(const json& routes, const SearchStats& st, double us) {
+    Answer ans;
+    for (const auto& r : routes) {
+        ans.costs.push_back(r["total_time"].get<int>());
+        ans.claimed.push_back(r["total_time"].get<int>());
+        vector<string> ids;
+        for (const auto& s : r["segments"]) ids.push_back(s["flight_id"]);
+        ans.routes.push_back(ids);
+    }
+    ans.states = st.pushed;
+    ans.us = us;
+    return ans;
+}
+
+static Answer run_smart(Case& c, const Query& q) {
+    SearchStats st;
+    auto t0 = bench_clock::now();
+    json routes = c.db->find_smart_routes(q.srcs, q.dsts, date_of(q.day), q.k, q.constraints, &st);
+    return from_json_routes(routes, st, chrono::duration<double, micro>(bench_clock::now() - t0).count());
+}
+
+static vector<Engine> make_engines() {
+    vector<Engine> engines;
+    engines.push_back({"smart", Rules::JSONDB, true, run_smart});
+
+    // Same search once the continuation memo holds a profile for the query
+    // (admitted on its second miss)
+    engines.push_back({"smart_memo", Rules::JSONDB, true, [](Case& c, const Query& q) {
+        run_smart(c, q);
+        return run_smart(c, q);
+    }});
+
+    for (int beam : {8, 32}) {
+        engines.push_back({"fast_b" + to_string(beam), Rules::JSONDB, false, [beam](Case& c, const Query& q) {
+            SearchStats st;
+            auto t0 = bench_clock::now();
+            json routes = c.db->find_fast_routes(q.srcs, q.dsts, date_of(q.day), q.k, beam, q.constraints, &st);
+            return from_json_routes(routes, st, chrono::duration<double, micro>(bench_clock::now() - t0).count());
+        }});
+    }
+
+    engines.push_back({"network", Rules::NETWORK, true, [](Case& c, const Query& q) {
+        network::SearchCounts counts;
+        auto t0 = bench_clock::now();
+        vector<network::PathResult> paths = c.net.getTopKPaths(q.srcs[0], q.dsts[0], q.k, q.min_layover, &counts);
+        Answer ans;
+        ans.us = chrono::duration<double, micro>(bench_clock::now() - t0).count();
+        ans.states = counts.pushed;
+        for (const auto& p : paths) {
+            ans.costs.push_back(p.totalCost);
+            ans.claimed.push_back(p.totalCost);
+            vector<string> ids;
+            for (const auto& seg : p.routeDescription) ids.push_back(seg.substr(0, seg.find(' '))); // "ID (A->B)"
+            ans.routes.push_back(ids);
+        }
+        return ans;
+    }});
+    return engines;
+}
+
+// ==========================================
+// COMPARISON
+// ==========================================
+
+struct Tally {
+    size_t checked = 0, mismatched = 0, invalid = 0;
+    size_t want = 0, matched = 0; // Costs, for recall
+    double us = 0;
+    size_t states = 0;
+};
+
+// How many reference costs the engine also reached (as a multiset)
+static size_t matched_costs(const vector<int>& reference, const vector<int>& got) {
+    multiset<int> want(reference.begin(), reference.end());
+    size_t hits = 0;
+    for (int cost : got) {
+        auto it = want.find(cost);
+        if (it != want.end()) { want.erase(it); hits++; }
+    }
+    return hits;
+}
+
+// Every route must be legal under the engine's rules, cost what the engine
+// says, and no route may beat the reference's at the same rank
+static string check_routes(const Case& c, const Query& q, Rules rules, const Answer& got, const vector<int>& reference) {
+    for (size_t i = 0; i < got.routes.size(); ++i) {
+        vector<const GenFlight*> legs;
+        for (const auto& id : got.routes[i]) {
+            auto it = c.by_id.find(id);
+            if (it == c.by_id.end()) return "unknown flight " + id;
+            legs.push_back(it->second);
+        }
+        int cost;
+        bool ok = rules == Rules::JSONDB ? jsondb_route_ok(q, legs, cost) : network_route_ok(q, legs, cost);
+        if (!ok) return "route " + to_string(i + 1) + " breaks the rules";
+        if (cost != got.claimed[i]) return "route " + to_string(i + 1) + " claims " + to_string(got.claimed[i]) +
+                                           ", costs " + to_string(cost);
+    }
+    vector<int> sorted = got.costs;
+    sort(sorted.begin(), sorted.end());
+    if (sorted.size() > reference.size()) return "more routes than exist";
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i] < reference[i]) return "rank " + to_string(i + 1) + " beats the reference";
+    }
+    return "";
+}
+
+static string costs_str(const vector<int>& v) {
+    string s = "[";
+    for (size_t i = 0; i < v.size(); ++i) s += (i ? " " : "") + to_string(v[i]);
+    return s + "]";
+}
+
+static void usage() {
+    cerr << "Usage: route_diff [cases] [queries_per_case] [seed] [airports (2-676)] [flights_per_day]" << endl;
+}
+
+// argv[i] as a whole number in [lo, hi], else `fallback` when absent
+static bool parse_arg(int argc, char** argv, int i, uint64_t lo, uint64_t hi, uint64_t fallback, uint64_t& out) {
+    out = fallback;
+    if (argc <= i) return true;
+    string s = argv[i];
+    if (s.empty() || s.find_first_not_of("0123456789") != string::npos) return false;
+    try { out = stoull(s); } catch (...) { return false; }
+    return out >= lo && out <= hi;
+}
+
+int main(int argc, char** argv) {
+    // Airport codes are two letters, so at most 26 * 26 airports
+    uint64_t n_cases, n_queries, seed, n_airports, per_day;
+    if (argc > 6 || !parse_arg(argc, argv, 1, 0, INT_MAX, 50, n_cases) ||
+        !parse_arg(argc, argv, 2, 0, INT_MAX, 40, n_queries) || !parse_arg(argc, argv, 3, 0, UINT64_MAX, 1, seed) ||
+        !parse_arg(argc, argv, 4, 2, 26 * 26, 8, n_airports) || !parse_arg(argc, argv, 5, 0, 100000, 40, per_day)) {
+        usage();
+        return 1;
+    }
+
+    vector<Engine> engines = make_engines();
+    vector<Tally> tallies(engines.size());
+    Tally reference[2]; // By Rules
+    size_t skipped = 0;
+    vector<string> failures;
+
+    // Every engine on one query, against both references
+    auto check_query = [&](Case& c, const Query& q, const string& where) {
+        Answer ref[2] = {enumerate(c, q, true), enumerate(c, q, false)};
+        if (!ref[0].complete || !ref[1].complete) { skipped++; return; }
+        for (int r = 0; r < 2; ++r) {
+            reference[r].checked++;
+            reference[r].us += ref[r].us;
+            reference[r].states += ref[r].states;
+        }
+
+        for (size_t e = 0; e < engines.size(); ++e) {
+            const Engine& eng = engines[e];
+            const vector<int>& want = ref[eng.rules == Rules::JSONDB ? 0 : 1].costs;
+            Answer got = eng.run(c, q);
+            Tally& t = tallies[e];
+            t.checked++;
+            t.us += got.us;
+            t.states += got.states;
+            t.want += want.size();
+            t.matched += matched_costs(want, got.costs);
+
+            string problem = check_routes(c, q, eng.rules, got, want);
+            if (!problem.empty()) {
+                t.invalid++;
+            } else if (eng.exact) {
+                vector<int> sorted = got.costs;
+                sort(sorted.begin(), sorted.end());
+                if (sorted != want) {
+                    t.mismatched++;
+                    problem = "expected " + costs_str(want) + ", got " + costs_str(got.costs);
+                }
+            }
+            if (!problem.empty() && failures.size() < SHOWN_FAILURES) {
+                failures.push_back(eng.name + " " + where + " (" + describe(q) + "): " + problem);
+            }
+        }
+    };
+
+    for (auto& fc : fixed_cases()) {
+        for (size_t qi = 0; qi < fc.queries.size(); ++qi) {
+            check_query(*fc.net, fc.queries[qi], fc.name + " query " + to_string(qi));
+        }
+    }
+
+    for (uint64_t ci = 0; ci < n_cases; ++ci) {
+        Case c(seed + ci, (int)n_airports, (int)per_day);
+        mt19937_64 rng(c.seed * 7919 + 17);
+        for (uint64_t qi = 0; qi < n_queries; ++qi) {
+            Query q = c.random_query(rng);
+            check_query(c, q, "case seed " + to_string(c.seed) + " query " + to_string(qi));
+        }
+    }
+
+    cout << "cases=" << n_cases << " queries/case=" << n_queries << " airports=" << n_airports
+         << " flights/day=" << per_day << " seed=" << seed << " skipped=" << skipped << "\n";
+    cout << "engine        rules    exact  queries  mismatched  invalid  recall    avg_us   avg_states\n";
+    auto row = [](const string& name, const char* rules, const char* exact, const Tally& t) {
+        double n = (double)max<size_t>(1, t.checked);
+        cout << left << setw(14) << name << setw(9) << rules << setw(7) << exact << right << setw(7) << t.checked
+             << setw(12) << t.mismatched << setw(9) << t.invalid << fixed << setprecision(3) << setw(8)
+             << (t.want ? (double)t.matched / t.want : 1.0) << setprecision(1) << setw(10) << t.us / n << setw(13)
+             << (double)t.states / n << "\n";
+    };
+    row("reference", "jsondb", "-", reference[0]);
+    row("reference", "network", "-", reference[1]);
+    bool failed = false;
+    for (size_t e = 0; e < engines.size(); ++e) {
+        row(engines[e].name, engines[e].rules == Rules::JSONDB ? "jsondb" : "network", engines[e].exact ? "yes" : "no",
+            tallies[e]);
+        failed |= tallies[e].invalid > 0 || (engines[e].exact && tallies[e].mismatched > 0);
+    }
+    for (const auto& f : failures) cout << "  " << f << "\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,102 @@
+// ==========================================
+// SEARCH BENCHMARK: exact vs fast (beam) mode
+// ==========================================
+// Runs sampled queries against a database file (seeding the full mesh if it
+// does not exist) and reports latency, labels expanded and the recall of
+// the beam search against the exact top K.
+//
+// Usage: search_bench [db_file] [queries] [k] [beam widths...]
+
+#include "jsondb.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Many routes tie on total time, so recall is measured on costs: how many
+// of the exact top-K totals the fast result also reaches
+static size_t matched_costs(const json& exact, const json& fast) {
+    multiset<int> want;
+    for (const auto& r : exact) want.insert(r["total_time"].get<int>());
+    size_t hits = 0;
+    for (const auto& r : fast) {
+        auto it = want.find(r["total_time"].get<int>());
+        if (it != want.end()) { want.erase(it); hits++; }
+    }
+    return hits;
+}
+
+struct Query {
+    string src, dst, date;
+};
+
+int main(int argc, char** argv) {
+    string db_file = argc > 1 ? argv[1] : "bench_database.json";
+    int n_queries = argc > 2 ? stoi(argv[2]) : 200;
+    int k = argc > 3 ? stoi(argv[3]) : 5;
+    vector<int> beams;
+    for (int i = 4; i < argc; ++i) beams.push_back(stoi(argv[i]));
+    if (beams.empty()) beams = {4, 8, 16, 32, 64};
+
+    JsonDB db(db_file);
+
+    vector<string> codes;
+    for (const auto& a : db.get_all_airports()) codes.push_back(a["code"]);
+    if (codes.size() < 2) {
+        cerr << "Need at least two airports" << endl;
+        return 1;
+    }
+
+    mt19937 rng(42);
+    vector<Query> queries;
+    for (int i = 0; i < n_queries; ++i) {
+        string src = codes[rng() % codes.size()], dst;
+        do { dst = codes[rng() % codes.size()]; } while (dst == src);
+        int day = 1 + (int)(rng() % 10);
+        queries.push_back({src, dst, "2025-12-" + string(day < 10 ? "0" : "") + to_string(day)});
+    }
+
+    using clock = chrono::steady_clock;
+
+    // Exact baseline
+    vector<json> exact(queries.size());
+    double exact_ms = 0;
+    size_t exact_labels = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        SearchStats st;
+        auto t0 = clock::now();
+        exact[i] = db.find_smart_routes(queries[i].src, queries[i].dst, queries[i].date, k, {}, &st);
+        exact_ms += chrono::duration<double, milli>(clock::now() - t0).count();
+        exact_labels += st.pushed;
+    }
+
+    cout << fixed << setprecision(3);
+    cout << "queries=" << queries.size() << " k=" << k << "\n";
+    cout << "mode      avg_ms   avg_labels  recall\n";
+    cout << "exact     " << setw(7) << exact_ms / queries.size() << "  "
+         << setw(10) << exact_labels / queries.size() << "  1.000\n";
+
+    for (int beam : beams) {
+        double ms = 0;
+        size_t labels = 0, hits = 0, wanted = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            SearchStats st;
+            auto t0 = clock::now();
+            json fast = db.find_fast_routes(queries[i].src, queries[i].dst, queries[i].date, k, beam, {}, &st);
+            ms += chrono::duration<double, milli>(clock::now() - t0).count();
+            labels += st.pushed;
+
+            wanted += exact[i].size();
+            hits += matched_costs(exact[i], fast);
+        }
+        double recall = wanted ? (double)hits / wanted : 1.0;
+        cout << "beam=" << setw(3) << left << beam << right << "  " << setw(7) << ms / queries.size() << "  "
+             << setw(10) << labels / queries.size() << "  " << recall << "\n";
+    }
+    return 0;
+}
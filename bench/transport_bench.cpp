@@ -0,0 +1,138 @@
+// ==========================================
+// TRANSPORT BENCHMARK: loopback TCP vs Unix domain socket
+// ==========================================
+// Drives a running server_app (started with FLIGHT_UDS_PATH set) with
+// keep-alive HTTP/1.1 GETs over both transports and reports throughput and
+// latency percentiles for each. Every connection runs on its own thread and
+// keeps one request in flight.
+//
+// Usage: transport_bench [tcp_port] [uds_path] [requests] [connections] [target]
+
+#include "metrics.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static int connect_tcp(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static int connect_unix(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+// One request / response exchange; false on a transport or framing error
+static bool exchange(int fd, const string& request, string& buf) {
+    if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+
+    char chunk[16 * 1024];
+    size_t head_end, length = 0;
+    while ((head_end = buf.find("\r\n\r\n")) == string::npos) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    for (size_t pos = buf.find("\r\n") + 2; pos < head_end;) {
+        size_t end = buf.find("\r\n", pos);
+        string line = buf.substr(pos, end - pos);
+        if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) length = stoul(line.substr(15));
+        pos = end + 2;
+    }
+    while (buf.size() < head_end + 4 + length) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+    }
+    buf.erase(0, head_end + 4 + length);
+    return true;
+}
+
+struct Result {
+    double seconds = 0;
+    size_t done = 0, failed = 0;
+};
+
+template <typename Connect>
+static Result run(Connect connect_fn, int requests, int connections, const string& target, LatencyHistogram& latency) {
+    string request = "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    vector<size_t> done(connections), failed(connections);
+    using clock = chrono::steady_clock;
+
+    auto start = clock::now();
+    vector<thread> workers;
+    for (int c = 0; c < connections; ++c) {
+        workers.emplace_back([&, c] {
+            int fd = connect_fn();
+            if (fd < 0) { failed[c] = 1; return; }
+            string buf;
+            for (int i = c; i < requests; i += connections) {
+                auto t0 = clock::now();
+                if (!exchange(fd, request, buf)) { failed[c]++; break; }
+                latency.record_us((uint64_t)chrono::duration_cast<chrono::microseconds>(clock::now() - t0).count());
+                done[c]++;
+            }
+            close(fd);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    Result r;
+    r.seconds = chrono::duration<double>(clock::now() - start).count();
+    for (int c = 0; c < connections; ++c) { r.done += done[c]; r.failed += failed[c]; }
+    return r;
+}
+
+static void report(const string& name, const Result& r, const LatencyHistogram& latency) {
+    cout << left << setw(10) << name << right << setw(9) << r.done << setw(8) << r.failed
+         << setw(12) << (r.seconds > 0 ? r.done / r.seconds : 0.0)
+         << setw(9) << latency.percentile_ms(0.50) << setw(9) << latency.percentile_ms(0.90)
+         << setw(9) << latency.percentile_ms(0.99) << "\n";
+}
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? stoi(argv[1]) : 8080;
+    string uds_path = argc > 2 ? argv[2] : "/tmp/flight.sock";
+    int requests = argc > 3 ? stoi(argv[3]) : 20000;
+    int connections = argc > 4 ? stoi(argv[4]) : 4;
+    string target = argc > 5 ? argv[5] : "/health";
+
+    cout << fixed << setprecision(3);
+    cout << "requests=" << requests << " connections=" << connections << " target=" << target << "\n";
+    cout << left << setw(10) << "transport" << right << setw(9) << "done" << setw(8) << "failed" << setw(12) << "req/s"
+         << setw(9) << "p50_ms" << setw(9) << "p90_ms" << setw(9) << "p99_ms" << "\n";
+
+    LatencyHistogram tcp_latency, uds_latency;
+    Result tcp = run([&] { return connect_tcp(port); }, requests, connections, target, tcp_latency);
+    report("tcp", tcp, tcp_latency);
+    Result uds = run([&] { return connect_unix(uds_path); }, requests, connections, target, uds_latency);
+    report("unix", uds, uds_latency);
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "binary_client.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+BinaryClient::~BinaryClient() {
+    close();
+}
+
+void BinaryClient::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool BinaryClient::connect_tcp(const string& host, int port) {
+    close();
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) { error = "Invalid address " + host; return false; }
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        error = strerror(errno);
+        close();
+        return false;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return true;
+}
+
+bool BinaryClient::connect_unix(const string& path) {
+    close();
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) { error = "Socket path too long"; return false; }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        error = strerror(errno);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool BinaryClient::call(uint8_t type, const string& body, uint8_t expect, string& reply) {
+    if (fd < 0) { error = "Not connected"; return false; }
+    uint32_t id = next_id++;
+    uint8_t reply_type;
+    uint32_t reply_id;
+    if (!write_frame(fd, type, id, body) || !read_frame(fd, reply_type, reply_id, reply)) {
+        error = "Connection lost";
+        close();
+        return false;
+    }
+    reply_bytes = reply.size();
+    if (reply_id != id) {
+        error = "Response out of order";
+        close();
+        return false;
+    }
+    if (reply_type == MSG_ERROR) {
+        WireReader r(reply.data(), reply.size());
+        int status = r.u16();
+        error = to_string(status) + " " + r.str();
+        return false;
+    }
+    if (reply_type != expect) { error = "Unexpected response type"; return false; }
+    return true;
+}
+
+bool BinaryClient::search(const WireSearch& query, WireResult& out) {
+    vector<WireResult> results;
+    if (!search_batch({query}, results)) return false;
+    out = move(results[0]);
+    return true;
+}
+
+bool BinaryClient::search_batch(const vector<WireSearch>& queries, vector<WireResult>& out) {
+    WireWriter w;
+    uint8_t type = MSG_SEARCH;
+    if (queries.size() == 1) {
+        encode_search(w, queries[0]);
+    } else {
+        type = MSG_BATCH_SEARCH;
+        w.u16((uint16_t)queries.size());
+        for (const auto& q : queries) encode_search(w, q);
+    }
+
+    string reply;
+    if (!call(type, w.bytes, MSG_ROUTES, reply)) return false;
+    WireReader r(reply.data(), reply.size());
+    if (!decode_routes(r, out) || out.size() != queries.size()) { error = "Malformed response"; return false; }
+    return true;
+}
+
+bool BinaryClient::lookup_flights(const vector<string>& ids, vector<WireFlight>& out) {
+    WireWriter w;
+    w.list(ids);
+    string reply;
+    if (!call(MSG_FLIGHT_LOOKUP, w.bytes, MSG_FLIGHTS, reply)) return false;
+    WireReader r(reply.data(), reply.size());
+    if (!decode_flights(r, out)) { error = "Malformed response"; return false; }
+    return true;
+}
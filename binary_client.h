@@ -0,0 +1,41 @@
+#ifndef BINARY_CLIENT_H
+#define BINARY_CLIENT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "binary_protocol.h"
+
+// Blocking client for the binary protocol. One request in flight at a
+// time, so use one client per thread. Every call returns false on a
+// transport or protocol error (see last_error()); the connection is closed
+// after a transport error.
+class BinaryClient {
+public:
+    BinaryClient() = default;
+    ~BinaryClient();
+    BinaryClient(const BinaryClient&) = delete;
+    BinaryClient& operator=(const BinaryClient&) = delete;
+
+    bool connect_tcp(const std::string& host, int port);
+    bool connect_unix(const std::string& path);
+    bool connected() const { return fd >= 0; }
+    void close();
+
+    bool search(const WireSearch& query, WireResult& out);
+    bool search_batch(const std::vector<WireSearch>& queries, std::vector<WireResult>& out);
+    bool lookup_flights(const std::vector<std::string>& ids, std::vector<WireFlight>& out);
+
+    const std::string& last_error() const { return error; }
+    size_t last_reply_bytes() const { return reply_bytes; } // Body size of the last response frame
+
+private:
+    bool call(uint8_t type, const std::string& body, uint8_t expect, std::string& reply);
+
+    int fd = -1;
+    uint32_t next_id = 1;
+    std::string error;
+    size_t reply_bytes = 0;
+};
+
+#endif
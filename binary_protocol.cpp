@@ -0,0 +1,219 @@
+#include "binary_protocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+using namespace std;
+
+// ==========================================
+// FIELDS
+// ==========================================
+
+void WireWriter::str(const string& s) {
+    size_t n = min(s.size(), (size_t)0xFFFF);
+    u16((uint16_t)n);
+    bytes.append(s, 0, n);
+}
+
+void WireWriter::list(const vector<string>& items) {
+    u16((uint16_t)min(items.size(), (size_t)0xFFFF));
+    for (size_t i = 0; i < items.size() && i < 0xFFFF; ++i) str(items[i]);
+}
+
+uint32_t WireReader::get(int width) {
+    if (!good || end - p < width) { good = false; return 0; }
+    uint32_t v = 0;
+    for (int i = 0; i < width; ++i) v |= (uint32_t)(uint8_t)p[i] << (8 * i);
+    p += width;
+    return v;
+}
+
+string WireReader::str() {
+    size_t n = u16();
+    if (!good || (size_t)(end - p) < n) { good = false; return string(); }
+    string s(p, n);
+    p += n;
+    return s;
+}
+
+vector<string> WireReader::list() {
+    vector<string> items(u16());
+    for (auto& s : items) s = str();
+    return items;
+}
+
+uint16_t WireStringTable::intern(const string& s) {
+    auto it = ids.find(s);
+    if (it != ids.end()) return it->second;
+    if (strings.size() >= 0xFFFF) { overflow = true; return 0xFFFF; }
+    uint16_t id = (uint16_t)strings.size();
+    ids.emplace(s, id);
+    strings.push_back(s);
+    return id;
+}
+
+void WireStringTable::write(WireWriter& w) const {
+    w.u16((uint16_t)strings.size());
+    for (const auto& s : strings) w.str(s);
+}
+
+bool WireStringTable::read(WireReader& r, vector<string>& out) {
+    out.resize(r.u16());
+    for (auto& s : out) s = r.str();
+    return r.ok();
+}
+
+// ==========================================
+// MESSAGES
+// ==========================================
+
+void encode_search(WireWriter& w, const WireSearch& s) {
+    w.u8(s.fast ? 1 : 0);
+    w.u8((uint8_t)max(0, min(s.k, 255)));
+    w.u16((uint16_t)max(0, min(s.beam, 0xFFFF)));
+    w.i32(s.max_price);
+    w.u8((uint8_t)(int8_t)max(-1, min(s.max_stops, 127)));
+    w.u16((uint16_t)max(0, min(s.seats, 0xFFFF)));
+    w.u32((uint32_t)max(0, s.timeout_ms));
+    w.str(s.date);
+    w.list(s.srcs);
+    w.list(s.dsts);
+    w.list(s.airlines);
+    w.list(s.avoid);
+    w.list(s.via);
+}
+
+bool decode_search(WireReader& r, WireSearch& s) {
+    s.fast = r.u8() & 1;
+    s.k = r.u8();
+    s.beam = r.u16();
+    s.max_price = r.i32();
+    s.max_stops = (int8_t)r.u8();
+    s.seats = r.u16();
+    s.timeout_ms = (int)min(r.u32(), (uint32_t)INT32_MAX);
+    s.date = r.str();
+    s.srcs = r.list();
+    s.dsts = r.list();
+    s.airlines = r.list();
+    s.avoid = r.list();
+    s.via = r.list();
+    return r.ok();
+}
+
+// Table index to string; clears ok when out of range
+static const string& lookup(WireReader& r, const vector<string>& table, bool& ok) {
+    static const string empty;
+    uint16_t id = r.u16();
+    if (id >= table.size()) { ok = false; return empty; }
+    return table[id];
+}
+
+bool decode_routes(WireReader& r, vector<WireResult>& out) {
+    vector<string> table;
+    if (!WireStringTable::read(r, table)) return false;
+    bool ok = true;
+    out.resize(r.u16());
+    for (auto& result : out) {
+        result.status = r.u16();
+        result.cancelled = r.u8() != 0;
+        result.routes.resize(r.u16());
+        for (auto& route : result.routes) {
+            route.total_minutes = r.i32();
+            route.total_price = r.i32();
+            route.legs.resize(r.u8());
+            for (auto& leg : route.legs) {
+                leg.flight_id = lookup(r, table, ok);
+                leg.airline = lookup(r, table, ok);
+                leg.from = lookup(r, table, ok);
+                leg.to = lookup(r, table, ok);
+                leg.date = lookup(r, table, ok);
+                leg.dep = r.u16();
+                leg.arr = r.u16();
+                leg.price = r.i32();
+            }
+            if (!r.ok()) return false;
+        }
+    }
+    return ok && r.ok();
+}
+
+bool decode_flights(WireReader& r, vector<WireFlight>& out) {
+    vector<string> table;
+    if (!WireStringTable::read(r, table)) return false;
+    bool ok = true;
+    out.resize(r.u16());
+    for (auto& f : out) {
+        f.found = r.u8() != 0;
+        f.id = lookup(r, table, ok);
+        f.airline = lookup(r, table, ok);
+        f.from = lookup(r, table, ok);
+        f.to = lookup(r, table, ok);
+        f.date = lookup(r, table, ok);
+        f.dep = r.u16();
+        f.arr = r.u16();
+        f.duration = r.u16();
+        f.price = r.i32();
+        f.capacity = r.i32();
+        f.seats_left = r.i32();
+    }
+    return ok && r.ok();
+}
+
+// ==========================================
+// FRAMES
+// ==========================================
+
+bool write_frame(int fd, uint8_t type, uint32_t request_id, const string& body) {
+    WireWriter head;
+    head.u32((uint32_t)(5 + body.size()));
+    head.u8(type);
+    head.u32(request_id);
+
+    iovec parts[2] = {{(void*)head.bytes.data(), head.bytes.size()}, {(void*)body.data(), body.size()}};
+    size_t total = head.bytes.size() + body.size(), sent = 0;
+    msghdr msg = {};
+    while (sent < total) {
+        // Skip what earlier partial writes already sent
+        iovec rest[2];
+        int n_rest = 0;
+        size_t skip = sent;
+        for (auto& part : parts) {
+            if (skip >= part.iov_len) { skip -= part.iov_len; continue; }
+            rest[n_rest++] = {(char*)part.iov_base + skip, part.iov_len - skip};
+            skip = 0;
+        }
+        msg.msg_iov = rest;
+        msg.msg_iovlen = n_rest;
+        ssize_t n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+static bool recv_exact(int fd, char* out, size_t n) {
+    while (n > 0) {
+        ssize_t got = recv(fd, out, n, MSG_WAITALL);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        out += got;
+        n -= (size_t)got;
+    }
+    return true;
+}
+
+bool read_frame(int fd, uint8_t& type, uint32_t& request_id, string& body) {
+    char head[9];
+    if (!recv_exact(fd, head, sizeof(head))) return false;
+    WireReader r(head, sizeof(head));
+    uint32_t length = r.u32();
+    type = r.u8();
+    request_id = r.u32();
+    if (length < 5 || length > MAX_FRAME_BYTES) return false;
+
+    body.resize(length - 5);
+    return body.empty() || recv_exact(fd, &body[0], body.size());
+}
@@ -0,0 +1,146 @@
+#ifndef BINARY_PROTOCOL_H
+#define BINARY_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ==========================================
+// WIRE FORMAT
+// ==========================================
+// Length-prefixed binary protocol for service-to-service search calls,
+// shared by BinaryServer and BinaryClient (no JsonDB dependency).
+//
+//   frame  := u32 length | u8 type | u32 request id | body   (length covers type..body)
+//   string := u16 length | bytes
+//
+// Integers are little-endian and fixed width. Responses start with a string
+// table: every airport code, airline, flight id and date in the response
+// is sent once and records refer to it by u16 index. Clock times travel as
+// minutes after midnight.
+
+enum MessageType : uint8_t {
+    MSG_SEARCH = 1,          // body: search
+    MSG_BATCH_SEARCH = 2,    // body: u16 n | search * n
+    MSG_FLIGHT_LOOKUP = 3,   // body: u16 n | string id * n
+    MSG_ROUTES = 0x81,       // body: table | u16 n | result * n (one per search asked)
+    MSG_FLIGHTS = 0x83,      // body: table | u16 n | flight * n
+    MSG_ERROR = 0xFF         // body: u16 status | string message
+};
+
+const size_t MAX_FRAME_BYTES = 16 * 1024 * 1024;
+
+// search := u8 flags (1 = fast) | u8 k | u16 beam | i32 max_price | i8 max_stops
+//           | u16 seats | u32 timeout_ms | date | list srcs | list dsts
+//           | list airlines | list avoid | list via          (list := u16 n | string * n)
+struct WireSearch {
+    std::vector<std::string> srcs, dsts; // Airport codes
+    std::string date;
+    int k = 5;
+    bool fast = false;
+    int beam = 32;
+    int max_price = -1;
+    int max_stops = -1;
+    int seats = 1;
+    std::vector<std::string> airlines, avoid, via;
+    int timeout_ms = 0;
+};
+
+// result := u16 status (200, or an HTTP-like error) | u8 cancelled | u16 n | route * n
+// route  := i32 total_minutes | i32 total_price | u8 n | leg * n
+// leg    := u16 flight_id | u16 airline | u16 from | u16 to | u16 date
+//           | u16 dep | u16 arr | i32 price                    (u16 = table index or minutes)
+struct WireLeg {
+    std::string flight_id, airline, from, to, date;
+    int dep, arr; // Minutes after midnight
+    int price;
+};
+
+struct WireRoute {
+    int total_minutes;
+    int total_price;
+    std::vector<WireLeg> legs;
+};
+
+struct WireResult {
+    int status = 200;
+    bool cancelled = false; // Hit its timeout; routes are the ones found by then
+    std::vector<WireRoute> routes;
+};
+
+// flight := u8 found | u16 id | u16 airline | u16 from | u16 to | u16 date | u16 dep | u16 arr
+//           | u16 duration | i32 price | i32 capacity | i32 seats_left
+struct WireFlight {
+    bool found = false;
+    std::string id, airline, from, to, date;
+    int dep = 0, arr = 0, duration = 0; // Minutes
+    int price = 0, capacity = 0;
+    int seats_left = -1;
+};
+
+// Appends fixed-width fields to a byte string
+class WireWriter {
+public:
+    std::string bytes;
+
+    void u8(uint8_t v) { bytes.push_back((char)v); }
+    void u16(uint16_t v) { put(v, 2); }
+    void u32(uint32_t v) { put(v, 4); }
+    void i32(int32_t v) { put((uint32_t)v, 4); }
+    void str(const std::string& s); // Longer than 65535 bytes is truncated
+    void list(const std::vector<std::string>& items);
+
+private:
+    void put(uint32_t v, int width) {
+        for (int i = 0; i < width; ++i) bytes.push_back((char)((v >> (8 * i)) & 0xFF));
+    }
+};
+
+// Reads fields back; a read past the end clears ok() and yields zeros
+class WireReader {
+public:
+    WireReader(const char* data, size_t size) : p(data), end(data + size) {}
+
+    bool ok() const { return good; }
+    bool at_end() const { return p == end; }
+    uint8_t u8() { return (uint8_t)get(1); }
+    uint16_t u16() { return (uint16_t)get(2); }
+    uint32_t u32() { return get(4); }
+    int32_t i32() { return (int32_t)get(4); }
+    std::string str();
+    std::vector<std::string> list();
+
+private:
+    uint32_t get(int width);
+
+    const char* p;
+    const char* end;
+    bool good = true;
+};
+
+// Response string table: intern while writing records, then emit first
+class WireStringTable {
+public:
+    uint16_t intern(const std::string& s); // 0xFFFF (and overflowed()) past 65535 distinct strings
+    bool overflowed() const { return overflow; }
+    void write(WireWriter& w) const;
+    static bool read(WireReader& r, std::vector<std::string>& out);
+
+private:
+    std::unordered_map<std::string, uint16_t> ids;
+    std::vector<std::string> strings;
+    bool overflow = false;
+};
+
+void encode_search(WireWriter& w, const WireSearch& s);
+bool decode_search(WireReader& r, WireSearch& s);
+bool decode_routes(WireReader& r, std::vector<WireResult>& out);
+bool decode_flights(WireReader& r, std::vector<WireFlight>& out);
+
+// Blocking frame I/O on a connected stream socket (POSIX)
+bool write_frame(int fd, uint8_t type, uint32_t request_id, const std::string& body);
+bool read_frame(int fd, uint8_t& type, uint32_t& request_id, std::string& body);
+
+#endif
@@ -0,0 +1,179 @@
+#include "binary_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+BinaryServer::BinaryServer(JsonDB& database, size_t max_connections)
+    : db(database),
+      tcp([this](int fd) { serve(fd); }, max_connections),
+      local([this](int fd) { serve(fd); }, max_connections) {}
+
+BinaryServer::~BinaryServer() {
+    stop();
+}
+
+bool BinaryServer::listen_tcp(const string& host, int port, string& error) {
+    return tcp.listen_tcp(host, port, error);
+}
+
+bool BinaryServer::listen_unix(const string& path, string& error) {
+    return local.listen_unix(path, error);
+}
+
+void BinaryServer::stop() {
+    shutdown.cancel();
+    tcp.stop();
+    local.stop();
+}
+
+BinaryServer::Stats BinaryServer::stats() const {
+    return {n_frames.load(), n_searches.load(), n_errors.load()};
+}
+
+// ==========================================
+// REQUESTS
+// ==========================================
+
+// "14:30" -> 870 (0 if malformed)
+static uint16_t clock_minutes(const string& hhmm) {
+    size_t colon = hhmm.find(':');
+    if (colon == string::npos) return 0;
+    int h = atoi(hhmm.c_str()), m = atoi(hhmm.c_str() + colon + 1);
+    return (uint16_t)max(0, h * 60 + m);
+}
+
+void BinaryServer::search(const WireSearch& q, WireStringTable& table, WireWriter& records) {
+    n_searches++;
+    if (q.srcs.empty() || q.dsts.empty() || q.date.empty() || q.k < 1) {
+        records.u16(400);
+        records.u8(0);
+        records.u16(0);
+        return;
+    }
+
+    SearchRequest r;
+    r.srcs = q.srcs;
+    r.dsts = q.dsts;
+    r.date = q.date;
+    r.k = q.k;
+    r.fast = q.fast;
+    r.beam = q.beam;
+    r.constraints.airlines = q.airlines;
+    r.constraints.max_price = q.max_price;
+    r.constraints.max_stops = q.max_stops;
+    r.constraints.avoid = q.avoid;
+    r.constraints.via = q.via;
+    r.constraints.seats = q.seats;
+    if (!r.constraints.via_fits()) {
+        records.u16(400);
+        records.u8(0);
+        records.u16(0);
+        return;
+    }
+
+    CancelToken cancel(&shutdown);
+    if (q.timeout_ms > 0) cancel.set_timeout(chrono::milliseconds(q.timeout_ms));
+    SearchStats stats;
+    json routes = run_search(db, r, &stats, nullptr, &cancel);
+
+    records.u16(200);
+    records.u8(stats.cancelled ? 1 : 0);
+    records.u16((uint16_t)routes.size());
+    for (const auto& route : routes) {
+        const json& segments = route["segments"];
+        records.i32(route["total_time"].get<int>());
+        records.i32(route["total_price"].get<int>());
+        records.u8((uint8_t)segments.size());
+        for (const auto& seg : segments) {
+            records.u16(table.intern(seg["flight_id"].get_ref<const string&>()));
+            records.u16(table.intern(seg["airline"].get_ref<const string&>()));
+            records.u16(table.intern(seg["from"].get_ref<const string&>()));
+            records.u16(table.intern(seg["to"].get_ref<const string&>()));
+            records.u16(table.intern(seg["date"].get_ref<const string&>()));
+            records.u16(clock_minutes(seg["dep"].get_ref<const string&>()));
+            records.u16(clock_minutes(seg["arr"].get_ref<const string&>()));
+            records.i32(seg["price"].get<int>());
+        }
+    }
+}
+
+void BinaryServer::lookup(const vector<string>& ids, WireStringTable& table, WireWriter& records) {
+    for (const auto& id : ids) {
+        FlightRecord f;
+        bool found = db.get_flight(id, f);
+        records.u8(found ? 1 : 0);
+        records.u16(table.intern(id));
+        records.u16(table.intern(found ? f.flight.airline : ""));
+        records.u16(table.intern(found ? f.flight.from_code : ""));
+        records.u16(table.intern(found ? f.flight.to_code : ""));
+        records.u16(table.intern(found ? f.flight.date : ""));
+        records.u16((uint16_t)(found ? f.dep_minutes : 0));
+        records.u16((uint16_t)(found ? f.arr_minutes : 0));
+        records.u16((uint16_t)(found ? f.duration_minutes : 0));
+        records.i32(found ? f.flight.price : 0);
+        records.i32(found ? f.flight.capacity : 0);
+        records.i32(found ? f.seats_left : -1);
+    }
+}
+
+// ==========================================
+// CONNECTIONS
+// ==========================================
+
+void BinaryServer::serve(int fd) {
+    uint8_t type;
+    uint32_t request_id;
+    string body;
+    while (read_frame(fd, type, request_id, body)) {
+        n_frames++;
+        WireReader in(body.data(), body.size());
+        WireStringTable table;
+        WireWriter records;
+        uint8_t reply = 0;
+        string error = "Malformed request";
+
+        if (type == MSG_SEARCH) {
+            WireSearch q;
+            if (decode_search(in, q)) {
+                records.u16(1);
+                search(q, table, records);
+                reply = MSG_ROUTES;
+            }
+        } else if (type == MSG_BATCH_SEARCH) {
+            vector<WireSearch> batch(in.u16());
+            bool ok = in.ok();
+            for (auto& q : batch) ok = ok && decode_search(in, q);
+            if (ok) {
+                records.u16((uint16_t)batch.size());
+                for (const auto& q : batch) search(q, table, records);
+                reply = MSG_ROUTES;
+            }
+        } else if (type == MSG_FLIGHT_LOOKUP) {
+            vector<string> ids = in.list();
+            if (in.ok()) {
+                records.u16((uint16_t)ids.size());
+                lookup(ids, table, records);
+                reply = MSG_FLIGHTS;
+            }
+        } else {
+            error = "Unknown message type";
+        }
+        if (reply && table.overflowed()) {
+            reply = 0;
+            error = "Response has too many distinct strings";
+        }
+
+        WireWriter out;
+        if (reply) {
+            table.write(out);
+            out.bytes += records.bytes;
+        } else {
+            n_errors++;
+            out.u16(400);
+            out.str(error);
+        }
+        if (!write_frame(fd, reply ? reply : (uint8_t)MSG_ERROR, request_id, out.bytes)) break;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef BINARY_SERVER_H
+#define BINARY_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "binary_protocol.h"
+#include "search_cache.h"
+#include "socket_listener.h"
+
+// Serves the binary protocol (binary_protocol.h) to internal clients on a
+// TCP port and / or a Unix socket: search, batch search and flight lookup,
+// one response frame per request frame, in order, per connection.
+// Searches bypass the HTTP response cache and JSON serialization.
+class BinaryServer {
+public:
+    explicit BinaryServer(JsonDB& db, size_t max_connections = 64);
+    ~BinaryServer(); // stop()
+
+    bool listen_tcp(const std::string& host, int port, std::string& error);
+    bool listen_unix(const std::string& path, std::string& error);
+    void stop(); // Cancels running searches, then closes every connection
+
+    struct Stats {
+        uint64_t frames, searches, errors;
+    };
+    Stats stats() const;
+
+private:
+    void serve(int fd);
+    void search(const WireSearch& q, WireStringTable& table, WireWriter& records);
+    void lookup(const std::vector<std::string>& ids, WireStringTable& table, WireWriter& records);
+
+    JsonDB& db;
+    CancelToken shutdown; // Parent of every request's token
+
+    std::atomic<uint64_t> n_frames{0}, n_searches{0}, n_errors{0};
+
+    // Last, so both stop (and join) before the members their threads use go away
+    SocketListener tcp, local;
+};
+
+#endif
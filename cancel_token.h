@@ -0,0 +1,53 @@
+#ifndef CANCEL_TOKEN_H
+#define CANCEL_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// Cooperative cancellation for long searches. Any thread may cancel();
+// the search polls cancelled() before each label it expands and returns
+// what it has so far. A token also trips once its deadline passes, its parent
+// (e.g. the server-wide shutdown token) is cancelled, or its probe (e.g. "is
+// the client still connected") reports false.
+class CancelToken {
+public:
+    CancelToken() = default;
+    explicit CancelToken(const CancelToken* parent) : parent(parent) {}
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    void cancel() { flag.store(true, std::memory_order_relaxed); }
+
+    // Set before the token is shared with the search
+    void set_timeout(std::chrono::milliseconds ms) {
+        deadline = std::chrono::steady_clock::now() + ms;
+        has_deadline = true;
+    }
+
+    // Set before the token is shared; asked every PROBE_EVERY polls, from
+    // the polling thread
+    static const uint32_t PROBE_EVERY = 64;
+    void set_probe(std::function<bool()> alive) { probe = std::move(alive); }
+
+    bool cancelled() const {
+        if (flag.load(std::memory_order_relaxed)) return true;
+        if (parent && parent->cancelled()) return true;
+        if (probe && polls.fetch_add(1, std::memory_order_relaxed) % PROBE_EVERY == 0 && !probe()) {
+            flag.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return has_deadline && std::chrono::steady_clock::now() >= deadline;
+    }
+
+private:
+    mutable std::atomic<bool> flag{false};
+    mutable std::atomic<uint32_t> polls{0};
+    std::function<bool()> probe;
+    const CancelToken* parent = nullptr;
+    bool has_deadline = false;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "continuation_memo.h"
+#include "jsondb.h"
+#include <algorithm>
+
+using namespace std;
+
+// ==========================================
+// PROFILE BUILD
+// ==========================================
+// Flights are scanned latest departure first, so when flight c (x -> y) is
+// reached, every flight out of y that departs after c lands is already
+// listed at y. c's tails are c + the cheapest tails at y departing no
+// earlier than c's arrival. Overnight flights (arrival clock <= departure)
+// would need tails not scanned yet, so they get a lone frontier node that
+// sends any search reaching it back to normal expansion.
+
+shared_ptr<const ContinuationProfile> ContinuationProfile::build(const unordered_map<string, vector<Edge>>& adj_list,
+                                                                 const unordered_set<string>& targets,
+                                                                 const string& date, int per_edge) {
+    auto profile = make_shared<ContinuationProfile>();
+    if (per_edge < 1) per_edge = 1;
+
+    vector<pair<const string*, const Edge*>> flights;
+    for (const auto& entry : adj_list) {
+        if (targets.count(entry.first)) continue; // Routes end at the first destination reached
+        for (const auto& e : entry.second) {
+            if (e.date == date && !e.cancelled) flights.push_back({&entry.first, &e});
+        }
+    }
+    sort(flights.begin(), flights.end(), [](const auto& a, const auto& b) {
+        return a.second->dep_minutes > b.second->dep_minutes;
+    });
+
+    auto by_minutes = [](const ContinuationNode* a, const ContinuationNode* b) { return a->minutes < b->minutes; };
+    auto add = [&](const string& from, const ContinuationNode& node) {
+        profile->nodes.push_back(node);
+        auto& list = profile->by_airport[from];
+        const ContinuationNode* p = &profile->nodes.back();
+        list.insert(upper_bound(list.begin(), list.end(), p, by_minutes), p);
+    };
+
+    for (const auto& f : flights) {
+        const Edge& e = *f.second;
+        int leg = e.weight_minutes + 60;
+
+        if (targets.count(e.destination)) {
+            add(*f.first, {&e, nullptr, leg, e.price, false});
+            continue;
+        }
+        if (e.arr_minutes <= e.dep_minutes) {
+            add(*f.first, {&e, nullptr, leg, e.price, true});
+            continue;
+        }
+
+        auto tails = profile->by_airport.find(e.destination);
+        if (tails == profile->by_airport.end()) continue;
+
+        // Collect first: adding at the origin may grow the list being read
+        vector<ContinuationNode> made;
+        for (const ContinuationNode* t : tails->second) {
+            if (t->edge->dep_minutes < e.arr_minutes) continue;
+            bool last = t->frontier || (int)made.size() + 1 == per_edge;
+            made.push_back({&e, t, leg + t->minutes, e.price + t->price, last});
+            if (last) break;
+        }
+        for (const auto& node : made) add(*f.first, node);
+    }
+    return profile;
+}
+
+const vector<const ContinuationNode*>* ContinuationProfile::from(const string& airport) const {
+    auto it = by_airport.find(airport);
+    return it == by_airport.end() ? nullptr : &it->second;
+}
+
+// ==========================================
+// SHARED MEMO
+// ==========================================
+
+void ContinuationMemo::reset_if_stale(uint64_t v) {
+    if (v == version) return;
+    lru.clear();
+    entries.clear();
+    misses.clear();
+    version = v;
+}
+
+shared_ptr<const ContinuationProfile> ContinuationMemo::find(const string& k, uint64_t v) {
+    lock_guard<mutex> lock(mtx);
+    reset_if_stale(v);
+    auto it = entries.find(k);
+    if (it == entries.end()) return nullptr;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+bool ContinuationMemo::admit(const string& k, uint64_t v) {
+    lock_guard<mutex> lock(mtx);
+    reset_if_stale(v);
+    if (misses.size() >= capacity * 16) misses.clear();
+    int& count = misses[k];
+    if (++count < admit_after) return false;
+    misses.erase(k);
+    return true;
+}
+
+void ContinuationMemo::erase_date(const string& date) {
+    lock_guard<mutex> lock(mtx);
+    string suffix = '|' + date;
+    for (auto it = lru.begin(); it != lru.end();) {
+        const string& k = it->first;
+        if (k.size() < suffix.size() || k.compare(k.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            ++it;
+            continue;
+        }
+        misses[k] = admit_after - 1;
+        entries.erase(k);
+        it = lru.erase(it);
+    }
+}
+
+void ContinuationMemo::store(const string& k, uint64_t v, shared_ptr<const ContinuationProfile> value) {
+    lock_guard<mutex> lock(mtx);
+    reset_if_stale(v);
+    auto it = entries.find(k);
+    if (it != entries.end()) {
+        it->second->second = move(value);
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.emplace_front(k, move(value));
+    entries[k] = lru.begin();
+    if (lru.size() > capacity) {
+        entries.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
+
+size_t ContinuationMemo::size() const {
+    lock_guard<mutex> lock(mtx);
+    return lru.size();
+}
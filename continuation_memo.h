@@ -0,0 +1,87 @@
+#ifndef CONTINUATION_MEMO_H
+#define CONTINUATION_MEMO_H
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct Edge;
+
+// One way to finish a route: `edge`, then `next` (nullptr once `edge` lands
+// at a destination). minutes / price cover the whole tail, with the layover
+// before every leg. `frontier` marks the last known tail through this edge:
+// every tail through it up to this cost is listed, costlier ones may not be.
+struct ContinuationNode {
+    const Edge* edge;
+    const ContinuationNode* next;
+    int minutes;
+    int price;
+    bool frontier;
+};
+
+// Best continuations from every airport to one destination set on one
+// date, for any ready time. Per airport, nodes are sorted by minutes; the
+// ones usable after landing at clock minute t have edge->dep_minutes >= t.
+class ContinuationProfile {
+public:
+    // Backward connection scan over the date's flights, keeping up to
+    // `per_edge` tails per flight
+    static std::shared_ptr<const ContinuationProfile> build(
+        const std::unordered_map<std::string, std::vector<Edge>>& adj_list,
+        const std::unordered_set<std::string>& targets, const std::string& date, int per_edge = 8);
+
+    // Candidates from `airport`, cheapest first (nullptr if none)
+    const std::vector<const ContinuationNode*>* from(const std::string& airport) const;
+
+    size_t node_count() const { return nodes.size(); }
+
+private:
+    std::deque<ContinuationNode> nodes; // Stable addresses
+    std::unordered_map<std::string, std::vector<const ContinuationNode*>> by_airport;
+};
+
+// Bounded LRU of continuation profiles shared by all searches, keyed by
+// destination set and date. Profiles point into the graph, so they belong
+// to one graph version: the first access with a newer version drops all.
+class ContinuationMemo {
+public:
+    explicit ContinuationMemo(size_t capacity = 64, int admit_after = 2)
+        : capacity(capacity), admit_after(admit_after) {}
+
+    // `targets` is a canonical (sorted) list of destination codes
+    static std::string key(const std::string& targets, const std::string& date) { return targets + '|' + date; }
+
+    std::shared_ptr<const ContinuationProfile> find(const std::string& key, uint64_t version);
+    void store(const std::string& key, uint64_t version, std::shared_ptr<const ContinuationProfile> value);
+
+    // Records a miss on `key`; true once the key has missed often enough to
+    // be worth building (one-off queries never pay for a profile)
+    bool admit(const std::string& key, uint64_t version);
+
+    // Drops the profiles for `date` (its flight times changed) but keeps
+    // them admitted: the next search to each destination set rebuilds it
+    void erase_date(const std::string& date);
+
+    size_t size() const;
+
+private:
+    void reset_if_stale(uint64_t version);
+
+    using Item = std::pair<std::string, std::shared_ptr<const ContinuationProfile>>;
+
+    mutable std::mutex mtx;
+    size_t capacity;
+    int admit_after;
+    uint64_t version = 0;
+    std::list<Item> lru; // Most recently used first
+    std::unordered_map<std::string, std::list<Item>::iterator> entries;
+    std::unordered_map<std::string, int> misses; // Admission counts, reset when full
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "geoindex.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const double EARTH_RADIUS_KM = 6371.0;
+static const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+static void to_unit_vector(double lat, double lng, double* out) {
+    double phi = lat * DEG_TO_RAD, lambda = lng * DEG_TO_RAD;
+    out[0] = cos(phi) * cos(lambda);
+    out[1] = cos(phi) * sin(lambda);
+    out[2] = sin(phi);
+}
+
+static double chord2(const double* a, const double* b) {
+    double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Chord length (on the unit sphere) <-> surface distance
+static double chord_to_km(double chord) {
+    return 2.0 * asin(min(1.0, chord / 2.0)) * EARTH_RADIUS_KM;
+}
+
+static double km_to_chord(double km) {
+    double angle = min(km / EARTH_RADIUS_KM, 3.14159265358979323846);
+    return 2.0 * sin(angle / 2.0);
+}
+
+double GeoIndex::distance_km(double lat1, double lng1, double lat2, double lng2) {
+    double a[3], b[3];
+    to_unit_vector(lat1, lng1, a);
+    to_unit_vector(lat2, lng2, b);
+    return chord_to_km(sqrt(chord2(a, b)));
+}
+
+void GeoIndex::clear() {
+    points.clear();
+}
+
+void GeoIndex::add(const string& code, double lat, double lng) {
+    Point p;
+    to_unit_vector(lat, lng, p.xyz);
+    p.code = code;
+    points.push_back(p);
+}
+
+void GeoIndex::build() {
+    build_range(0, points.size(), 0);
+}
+
+void GeoIndex::build_range(size_t lo, size_t hi, int depth) {
+    if (hi - lo <= 1) return;
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = depth % 3;
+    nth_element(points.begin() + lo, points.begin() + mid, points.begin() + hi,
+                [axis](const Point& a, const Point& b) { return a.xyz[axis] < b.xyz[axis]; });
+    build_range(lo, mid, depth + 1);
+    build_range(mid + 1, hi, depth + 1);
+}
+
+GeoIndex::Hit GeoIndex::to_hit(size_t idx, const double* q) const {
+    return {points[idx].code, chord_to_km(sqrt(chord2(points[idx].xyz, q)))};
+}
+
+// ==========================================
+// RADIUS QUERY
+// ==========================================
+
+void GeoIndex::radius_range(size_t lo, size_t hi, int depth, const double* q, double max_d2,
+                            vector<size_t>& out) const {
+    if (lo >= hi) return;
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = depth % 3;
+
+    if (chord2(points[mid].xyz, q) <= max_d2) out.push_back(mid);
+
+    double diff = q[axis] - points[mid].xyz[axis];
+    // Near side first; the far side only if the splitting plane is in range
+    if (diff < 0) {
+        radius_range(lo, mid, depth + 1, q, max_d2, out);
+        if (diff * diff <= max_d2) radius_range(mid + 1, hi, depth + 1, q, max_d2, out);
+    } else {
+        radius_range(mid + 1, hi, depth + 1, q, max_d2, out);
+        if (diff * diff <= max_d2) radius_range(lo, mid, depth + 1, q, max_d2, out);
+    }
+}
+
+vector<GeoIndex::Hit> GeoIndex::within_radius(double lat, double lng, double radius_km) const {
+    double q[3];
+    to_unit_vector(lat, lng, q);
+    double chord = km_to_chord(max(0.0, radius_km));
+
+    vector<size_t> found;
+    radius_range(0, points.size(), 0, q, chord * chord, found);
+
+    vector<Hit> hits;
+    for (size_t idx : found) hits.push_back(to_hit(idx, q));
+    sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.distance_km < b.distance_km; });
+    return hits;
+}
+
+// ==========================================
+// NEAREST-N QUERY
+// ==========================================
+
+void GeoIndex::nearest_range(size_t lo, size_t hi, int depth, const double* q, size_t n,
+                             vector<pair<double, size_t>>& heap) const {
+    if (lo >= hi) return;
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = depth % 3;
+
+    // `heap` is a max-heap of the n best (distance^2, index) seen so far
+    double d2 = chord2(points[mid].xyz, q);
+    if (heap.size() < n) {
+        heap.push_back({d2, mid});
+        push_heap(heap.begin(), heap.end());
+    } else if (d2 < heap.front().first) {
+        pop_heap(heap.begin(), heap.end());
+        heap.back() = {d2, mid};
+        push_heap(heap.begin(), heap.end());
+    }
+
+    double diff = q[axis] - points[mid].xyz[axis];
+    size_t near_lo = diff < 0 ? lo : mid + 1, near_hi = diff < 0 ? mid : hi;
+    size_t far_lo = diff < 0 ? mid + 1 : lo, far_hi = diff < 0 ? hi : mid;
+
+    nearest_range(near_lo, near_hi, depth + 1, q, n, heap);
+    if (heap.size() < n || diff * diff < heap.front().first) {
+        nearest_range(far_lo, far_hi, depth + 1, q, n, heap);
+    }
+}
+
+vector<GeoIndex::Hit> GeoIndex::nearest(double lat, double lng, size_t n) const {
+    vector<Hit> hits;
+    if (n == 0) return hits;
+
+    double q[3];
+    to_unit_vector(lat, lng, q);
+
+    vector<pair<double, size_t>> heap;
+    nearest_range(0, points.size(), 0, q, n, heap);
+    sort_heap(heap.begin(), heap.end());
+
+    for (const auto& entry : heap) hits.push_back(to_hit(entry.second, q));
+    return hits;
+}
@@ -0,0 +1,44 @@
+#ifndef GEOINDEX_H
+#define GEOINDEX_H
+
+#include <string>
+#include <vector>
+
+// Spatial index over airport coordinates for radius and nearest-N queries.
+// Points are stored as unit vectors in a 3-d k-d tree, so straight-line
+// (chord) distance orders points exactly like great-circle distance and
+// there are no special cases at the antimeridian or the poles.
+class GeoIndex {
+public:
+    struct Hit {
+        std::string code;
+        double distance_km;
+    };
+
+    void clear();
+    void add(const std::string& code, double lat, double lng);
+    void build(); // Call once after the last add()
+
+    // Both return hits ordered by distance, nearest first
+    std::vector<Hit> within_radius(double lat, double lng, double radius_km) const;
+    std::vector<Hit> nearest(double lat, double lng, size_t n) const;
+
+    static double distance_km(double lat1, double lng1, double lat2, double lng2);
+
+private:
+    struct Point {
+        double xyz[3];
+        std::string code;
+    };
+
+    // Points are kept in k-d order: the median of [lo, hi) splits on axis depth % 3
+    std::vector<Point> points;
+
+    void build_range(size_t lo, size_t hi, int depth);
+    void radius_range(size_t lo, size_t hi, int depth, const double* q, double max_d2, std::vector<size_t>& out) const;
+    void nearest_range(size_t lo, size_t hi, int depth, const double* q, size_t n,
+                       std::vector<std::pair<double, size_t>>& heap) const;
+    Hit to_hit(size_t idx, const double* q) const;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include "hold_manager.h"
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+HoldManager::HoldManager(SeatInventory& inv, chrono::milliseconds tick_len)
+    : inventory(inv), tick(tick_len), epoch(chrono::steady_clock::now()), wheel(0) {
+    expiry_thread = thread(&HoldManager::run, this);
+}
+
+HoldManager::~HoldManager() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    expiry_thread.join();
+}
+
+uint64_t HoldManager::now_tick() const {
+    return (uint64_t)((chrono::steady_clock::now() - epoch) / tick);
+}
+
+// ==========================================
+// HOLD LIFECYCLE
+// ==========================================
+
+HoldManager::PlaceResult HoldManager::place(const vector<string>& flight_ids, int seats, int ttl_seconds) {
+    PlaceResult res;
+    res.status = inventory.reserve(flight_ids, seats, &res.failed_flight);
+    if (res.status != SeatInventory::Result::OK) return res;
+
+    static thread_local mt19937 rng(random_device{}());
+    uint32_t token = rng();
+
+    uint64_t ttl_ticks = (uint64_t)(chrono::seconds(ttl_seconds) / tick);
+    if (ttl_ticks == 0) ttl_ticks = 1;
+
+    lock_guard<mutex> lock(mtx);
+    uint64_t number = next_hold++;
+    // Schedule relative to the wheel's clock, which the expiry thread owns
+    uint64_t expire = max(wheel.now(), now_tick()) + ttl_ticks;
+    holds[number] = {flight_ids, seats, token, wheel.schedule(expire, number)};
+    n_placed++;
+
+    ostringstream id;
+    id << "H" << number << "-" << hex << token;
+    res.hold_id = id.str();
+    return res;
+}
+
+bool HoldManager::take(const string& hold_id, Hold& out) {
+    // "H<number>-<hex token>"
+    uint64_t number;
+    uint32_t token;
+    try {
+        size_t dash = hold_id.find('-');
+        if (hold_id.size() < 4 || hold_id[0] != 'H' || dash == string::npos) return false;
+        number = stoull(hold_id.substr(1, dash - 1));
+        token = (uint32_t)stoul(hold_id.substr(dash + 1), nullptr, 16);
+    } catch (...) {
+        return false;
+    }
+
+    auto it = holds.find(number);
+    if (it == holds.end() || it->second.token != token) return false;
+    wheel.cancel(it->second.timer);
+    out = move(it->second);
+    holds.erase(it);
+    return true;
+}
+
+bool HoldManager::confirm(const string& hold_id, vector<string>* flights, int* seats) {
+    lock_guard<mutex> lock(mtx);
+    Hold h;
+    if (!take(hold_id, h)) return false;
+    n_confirmed++;
+    if (flights) *flights = move(h.flights);
+    if (seats) *seats = h.seats;
+    return true;
+}
+
+bool HoldManager::release(const string& hold_id) {
+    Hold h;
+    {
+        lock_guard<mutex> lock(mtx);
+        if (!take(hold_id, h)) return false;
+        n_released++;
+    }
+    inventory.release(h.flights, h.seats);
+    return true;
+}
+
+unordered_map<string, int> HoldManager::held_seats() {
+    lock_guard<mutex> lock(mtx);
+    unordered_map<string, int> held;
+    for (const auto& entry : holds) {
+        for (const auto& id : entry.second.flights) held[id] += entry.second.seats;
+    }
+    return held;
+}
+
+HoldManager::Stats HoldManager::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {holds.size(), n_placed, n_confirmed, n_released, n_expired};
+}
+
+// ==========================================
+// EXPIRY THREAD
+// ==========================================
+
+void HoldManager::run() {
+    vector<uint64_t> expired;
+    vector<Hold> to_release;
+
+    unique_lock<mutex> lock(mtx);
+    while (!stopping) {
+        wake.wait_for(lock, tick);
+        if (stopping) break;
+
+        expired.clear();
+        wheel.advance(now_tick(), expired);
+        for (uint64_t number : expired) {
+            auto it = holds.find(number);
+            if (it == holds.end()) continue;
+            to_release.push_back(move(it->second));
+            holds.erase(it);
+        }
+        n_expired += to_release.size();
+
+        // Hand the seats back without blocking new holds
+        if (!to_release.empty()) {
+            lock.unlock();
+            for (const auto& h : to_release) inventory.release(h.flights, h.seats);
+            to_release.clear();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef HOLD_MANAGER_H
+#define HOLD_MANAGER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "seat_inventory.h"
+#include "timer_wheel.h"
+
+// Timed seat holds: seats are taken from the inventory when a hold is
+// placed and either kept (confirm), returned (release) or returned
+// automatically once the hold expires. Expiry runs on a single background
+// thread that advances a TimerWheel once per tick and releases every
+// expired hold in bulk; there is no per-hold thread or sleep.
+class HoldManager {
+public:
+    explicit HoldManager(SeatInventory& inventory,
+                         std::chrono::milliseconds tick = std::chrono::milliseconds(100));
+    ~HoldManager(); // Stops the expiry thread (outstanding holds are not released)
+
+    struct PlaceResult {
+        SeatInventory::Result status;
+        std::string hold_id;        // Set when status == OK
+        std::string failed_flight;  // Set otherwise
+    };
+
+    PlaceResult place(const std::vector<std::string>& flight_ids, int seats, int ttl_seconds);
+    // Seats stay sold; reports the hold's flights and seats (see JsonDB::commit_hold)
+    bool confirm(const std::string& hold_id, std::vector<std::string>* flights = nullptr, int* seats = nullptr);
+    bool release(const std::string& hold_id); // Seats go back now
+
+    std::unordered_map<std::string, int> held_seats(); // Per flight, over outstanding holds
+
+    struct Stats {
+        size_t outstanding;
+        uint64_t placed, confirmed, released, expired;
+    };
+    Stats stats();
+
+private:
+    struct Hold {
+        std::vector<std::string> flights;
+        int seats;
+        uint32_t token;              // Random part of the id, so ids can't be guessed
+        TimerWheel::TimerId timer;
+    };
+
+    SeatInventory& inventory;
+    const std::chrono::milliseconds tick;
+    const std::chrono::steady_clock::time_point epoch;
+
+    std::mutex mtx; // Guards everything below
+    TimerWheel wheel;
+    std::unordered_map<uint64_t, Hold> holds;
+    uint64_t next_hold = 1;
+    uint64_t n_placed = 0, n_confirmed = 0, n_released = 0, n_expired = 0;
+    bool stopping = false;
+    std::condition_variable wake;
+
+    std::thread expiry_thread;
+
+    uint64_t now_tick() const;
+    bool take(const std::string& hold_id, Hold& out); // Removes the hold and its timer
+    void run();
+};
+
+#endif
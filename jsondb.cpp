@@ -3,8 +3,14 @@
 #include <iostream>
 #include <queue>
 #include <set>
+#include <bitset>
+#include <algorithm>
+#include <unordered_set>
 #include <cstdlib> 
 #include <ctime>   
+#include <cctype>
+#include <climits>
+#include <cstdio>
 #include <mutex> // <--- Added explicit include to fix 'mutex not declared'
 
 using namespace std;
@@ -13,7 +19,9 @@ using namespace std;
 // CONSTRUCTOR & HELPERS
 // ==========================================
 
-JsonDB::JsonDB(const string& fname) : filename(fname) {
+JsonDB::JsonDB(const string& fname)
+    : filename(fname), price_log(fname + ".prices"), journal_path(fname + ".status"),
+      bookings_path(fname + ".bookings") {
     ifstream file(filename);
     if (file.is_open()) {
         try { file >> data; } catch (...) { data = json::object(); }
@@ -25,12 +33,48 @@ JsonDB::JsonDB(const string& fname) : filename(fname) {
     }
     
     // Always build the graph for the algorithm on startup
+    build_indexes();
     build_graph();
+    replay_journal();
+    replay_bookings();
+
+    for (const auto& a : data.value("airports", json::array())) suggest_index.add(a);
 }
 
 void JsonDB::save() {
+    unique_lock<shared_mutex> no_bookings(booking_mutex);
+
+    // Persist live seat counts alongside the flights; held seats count as free
+    if (data.contains("flights")) {
+        unordered_map<string, int> held;
+        if (held_seats) held = held_seats();
+        for (auto& f : data["flights"]) {
+            const string& id = f["id"].get_ref<const string&>();
+            int left = inventory.available(id);
+            auto h = held.find(id);
+            if (left >= 0) f["seats_available"] = left + (h == held.end() ? 0 : h->second);
+        }
+    }
+
     ofstream file(filename);
     file << data.dump(4);
+    file.close();
+    price_log.flush();
+    data_version = ++version_clock;
+
+    // The file now has every status event and booking applied so far
+    if (journal_events > 0) {
+        journal.close();
+        ofstream(journal_path, ios::trunc);
+        journal_events = 0;
+    }
+    if (booking_events > 0) {
+        lock_guard<mutex> lock(booking_append);
+        bookings.close();
+        ofstream(bookings_path, ios::trunc);
+        booking_events = 0;
+    }
+    no_bookings.unlock();
     // Rebuild graph whenever data changes
     build_graph();
 }
@@ -54,9 +98,37 @@ int JsonDB::parse_duration_string(const string& dur) {
     }
 }
 
+static string to_lower(string s) {
+    for (auto& ch : s) ch = (char)tolower((unsigned char)ch);
+    return s;
+}
+
+int JsonDB::parse_clock_string(const string& hhmm) {
+    // "14:30" -> 870; compares the same way the "HH:MM" strings do
+    try {
+        size_t colon = hhmm.find(':');
+        if (colon == string::npos) return 0;
+        return stoi(hhmm.substr(0, colon)) * 60 + stoi(hhmm.substr(colon + 1));
+    } catch (...) {
+        return 0;
+    }
+}
+
 void JsonDB::build_graph() {
     // Note: We don't lock here because this is an internal helper called by locked functions
     adj_list.clear();
+    edge_by_id.clear();
+    airline_ids.clear();
+    geo.clear();
+    city_airports.clear();
+
+    if (data.contains("airports")) {
+        for (const auto& a : data["airports"]) {
+            geo.add(a["code"], a["lat"], a["long"]);
+            city_airports[to_lower(a["city"])].push_back(a["code"]);
+        }
+    }
+    geo.build();
     
     if (!data.contains("flights")) return;
 
@@ -69,112 +141,442 @@ void JsonDB::build_graph() {
         e.arr_time = f["arrival"];
         e.price = f["price"];
         e.airline = f["airline"];
+        e.airline_id = airline_ids.emplace(e.airline, (int)airline_ids.size()).first->second;
         e.weight_minutes = parse_duration_string(f["duration"]);
+        e.seats = inventory.ensure(e.flight_id, f.value("seats_available", f.value("capacity", DEFAULT_FLIGHT_CAPACITY)));
+        e.dep_minutes = parse_clock_string(e.dep_time);
+        e.arr_minutes = parse_clock_string(e.arr_time);
+        e.cancelled = f.value("status", "") == "cancelled";
 
         adj_list[f["from_code"]].push_back(e);
     }
+    for (auto& entry : adj_list) {
+        for (auto& e : entry.second) edge_by_id[e.flight_id] = &e;
+    }
 }
 
 // ==========================================
 // THE K-SHORTEST PATH ALGORITHM
 // ==========================================
 
-struct PathState {
+// A partial route ending at `node`. Routes share their prefixes through
+// `parent` (an index into the label pool) instead of copying edge lists.
+struct Label {
     int total_minutes;
-    string current_node;
-    vector<Edge> history;
+    int total_price;
+    int arrival;         // Clock minute of the last arrival (-1 at the origin)
+    int legs;            // Edges taken so far (stops = legs - 1)
+    unsigned via_mask;   // Bit i set once constraints.via[i] has been visited
+    int parent;          // -1 for the origin label
+    const Edge* edge;    // Edge taken from the parent (nullptr at the origin)
+    const string* node;
+};
 
-    bool operator>(const PathState& other) const {
-        return total_minutes > other.total_minutes;
+// `a` is at least as good as `b` in every criterion that matters for any
+// continuation: arrives no later, costs no more time or money, has no more
+// stops and has covered every via airport `b` has.
+static bool dominates(const Label& a, const Label& b) {
+    return a.arrival <= b.arrival &&
+           a.total_minutes <= b.total_minutes &&
+           a.total_price <= b.total_price &&
+           a.legs <= b.legs &&
+           (a.via_mask & b.via_mask) == b.via_mask;
+}
+
+// Every airport the path into labels[a] stopped at is also on the path
+// into labels[b] (both given as the label before the last leg). Routes may
+// not revisit an airport, so only then is every continuation open to b also
+// open to a.
+static bool stops_subset(const vector<Label>& labels, int a, int b) {
+    for (int i = a; i != -1 && labels[i].parent != -1; i = labels[i].parent) {
+        bool found = false;
+        for (int j = b; j != -1 && labels[j].parent != -1; j = labels[j].parent) {
+            if (*labels[j].node == *labels[i].node) { found = true; break; }
+        }
+        if (!found) return false;
     }
+    return true;
+}
+
+// SearchConstraints resolved against the current graph so the per-edge
+// checks are index lookups
+struct ResolvedConstraints {
+    vector<char> airline_ok;              // Empty = any airline
+    set<string> avoid;
+    unordered_map<string, unsigned> via_bit;
+    unsigned via_done = 0;
+    int max_price = -1;
+    int max_stops = -1;
+    int seats = 0;
+};
+
+// The (possibly multi-airport) ends of one search. All sources act as a
+// single virtual origin and all targets as a single virtual destination.
+struct Endpoints {
+    vector<string> sources;
+    unordered_set<string> source_set;
+    unordered_set<string> targets;
 };
 
-json JsonDB::find_smart_routes(const string& src, const string& dst, const string& req_date, int k) {
+static Endpoints make_endpoints(const vector<string>& srcs, const vector<string>& dsts) {
+    Endpoints ep;
+    for (const auto& code : srcs) {
+        if (ep.source_set.insert(code).second) ep.sources.push_back(code);
+    }
+    ep.targets.insert(dsts.begin(), dsts.end());
+    return ep;
+}
+
+static ResolvedConstraints resolve_constraints(const SearchConstraints& c, const Endpoints& ep,
+                                               const unordered_map<string, int>& airline_ids) {
+    ResolvedConstraints rc;
+    if (!c.airlines.empty()) {
+        rc.airline_ok.assign(airline_ids.size(), 0);
+        for (const auto& name : c.airlines) {
+            auto it = airline_ids.find(name);
+            if (it != airline_ids.end()) rc.airline_ok[it->second] = 1;
+        }
+    }
+    rc.avoid.insert(c.avoid.begin(), c.avoid.end());
+
+    // Via airports equal to the endpoints are satisfied trivially. Requests
+    // with more than fit the mask are rejected up front (via_fits()); the
+    // size check only keeps the shift defined.
+    for (const auto& code : c.via) {
+        if (ep.source_set.count(code) || ep.targets.count(code) || rc.via_bit.count(code) ||
+            rc.via_bit.size() >= SearchConstraints::MAX_VIA_AIRPORTS) continue;
+        unsigned bit = 1u << rc.via_bit.size();
+        rc.via_bit[code] = bit;
+        rc.via_done |= bit;
+    }
+    rc.max_price = c.max_price;
+    rc.max_stops = c.max_stops;
+    rc.seats = c.seats;
+    return rc;
+}
+
+// Builds the label for taking `edge` out of labels[idx]. Returns false when
+// the edge is on the wrong date, breaks a constraint, revisits an airport
+// or departs before the previous flight lands.
+static bool extend_label(const vector<Label>& labels, int idx, const Edge& edge,
+                         const Endpoints& ep, const string& req_date,
+                         const ResolvedConstraints& rc, Label& next) {
+    const Label& top = labels[idx];
+
+    if (edge.date != req_date || edge.cancelled) return false;
+
+    // --- Constraint pruning ---
+    if (!rc.airline_ok.empty() && !rc.airline_ok[edge.airline_id]) return false;
+    if (rc.avoid.count(edge.destination)) return false;
+    if (rc.seats > 0 && edge.seats && edge.seats->load(memory_order_relaxed) < rc.seats) return false;
+
+    int new_price = top.total_price + edge.price;
+    if (rc.max_price >= 0 && new_price > rc.max_price) return false;
+
+    unsigned new_mask = top.via_mask;
+    auto vb = rc.via_bit.find(edge.destination);
+    if (vb != rc.via_bit.end()) new_mask |= vb->second;
+
+    if (ep.targets.count(edge.destination)) {
+        if (new_mask != rc.via_done) return false;
+    } else if (rc.max_stops >= 0) {
+        // Landing here is one stop; every missing via airport is another
+        int missing = (int)bitset<32>(rc.via_done & ~new_mask).count();
+        if (top.legs + 1 + missing > rc.max_stops) return false;
+    }
+
+    // No revisits, and no hopping between airports of the virtual origin
+    if (ep.source_set.count(edge.destination)) return false;
+    for (int i = idx; labels[i].parent != -1; i = labels[i].parent) {
+        if (labels[i].edge->destination == edge.destination) return false;
+    }
+
+    if (top.arrival >= 0 && edge.dep_minutes < top.arrival) return false;
+
+    int layover = top.legs == 0 ? 0 : 60; 
+
+    next = {
+        top.total_minutes + edge.weight_minutes + layover,
+        new_price,
+        edge.arr_minutes,
+        top.legs + 1,
+        new_mask,
+        idx,
+        &edge,
+        &edge.destination
+    };
+    return true;
+}
+
+// Walks the parent chain of labels[idx] into the /api/search route format
+static json label_to_route(const vector<Label>& labels, int idx) {
+    const Label& top = labels[idx];
+
+    json route;
+    route["total_time"] = top.total_minutes;
+    
+    int h = top.total_minutes / 60;
+    int m = top.total_minutes % 60;
+    route["duration_fmt"] = to_string(h) + "h " + to_string(m) + "m";
+    
+    route["stops"] = top.legs - 1;
+
+    vector<const Edge*> path;
+    int root = idx;
+    for (; labels[root].parent != -1; root = labels[root].parent) path.push_back(labels[root].edge);
+    
+    json segments = json::array();
+    string current_from = *labels[root].node; 
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        const Edge& h = **it;
+        segments.push_back({
+            {"airline", h.airline},
+            {"flight_id", h.flight_id},
+            {"from", current_from}, 
+            {"to", h.destination},
+            {"dep", h.dep_time},
+            {"arr", h.arr_time},
+            {"price", h.price},
+            {"date", h.date}
+        });
+        current_from = h.destination;
+    }
+    
+    route["segments"] = segments;
+    route["total_price"] = top.total_price;
+    return route;
+}
+
+// ==========================================
+// CONTINUATION MEMO
+// ==========================================
+// A popped label at a hub (after at least one leg) only needs the best few
+// ways to finish from there, and those are the same for every query to the
+// same destinations on the same date. A ContinuationProfile holds them for
+// every hub and ready time at once, so repeated searches complete hub labels
+// from it instead of expanding them. Tails are re-checked against the
+// label's path and constraints; the profile lists tails in cost order, so
+// the first `need` that pass are exactly the label's best completions.
+// When the known tails run out first, the label is expanded as usual.
+
+// Completes labels[idx] from the profile. Returns false (leaving `labels`
+// and `pq` untouched) when the label has to be expanded normally.
+template <typename Queue>
+static bool complete_from_memo(const Endpoints& ep, const ResolvedConstraints& rc, const string& req_date, int need,
+                               vector<Label>& labels, int idx, Queue& pq, SearchStats& st,
+                               const ContinuationProfile& profile) {
+    const vector<const ContinuationNode*>* tails = profile.from(*labels[idx].node);
+    int ready = labels[idx].arrival;
+
+    size_t mark = labels.size();
+    vector<int> finals;
+    bool complete = true;
+    if (tails) {
+        for (const ContinuationNode* t : *tails) {
+            if (t->edge->dep_minutes < ready) continue;
+
+            int cur = idx;
+            for (const ContinuationNode* n = t; n; n = n->next) {
+                Label next;
+                if (!extend_label(labels, cur, *n->edge, ep, req_date, rc, next)) { cur = -1; break; }
+                cur = (int)labels.size();
+                labels.push_back(next);
+            }
+            // Overnight placeholders end short of a destination
+            if (cur >= 0 && ep.targets.count(*labels[cur].node)) finals.push_back(cur);
+            if ((int)finals.size() >= need) break;
+            if (t->frontier) { complete = false; break; }
+        }
+    }
+
+    if ((int)finals.size() < need && !complete) {
+        labels.resize(mark);
+        st.memo_misses++;
+        return false;
+    }
+    for (int f : finals) {
+        pq.push({labels[f].total_minutes, f});
+        st.pushed++;
+    }
+    st.memo_hits++;
+    return true;
+}
+
+json JsonDB::find_smart_routes(const vector<string>& srcs, const vector<string>& dsts, const string& req_date, int k,
+                               const SearchConstraints& constraints, SearchStats* stats,
+                               const RouteCallback& on_route, const CancelToken* cancel) {
     lock_guard<mutex> lock(db_mutex); // Now this will work because headers are correct
     
     json results = json::array();
-    
-    priority_queue<PathState, vector<PathState>, greater<PathState>> pq;
-    pq.push({0, src, {}});
+    SearchStats local_stats;
+    SearchStats& st = stats ? *stats : local_stats;
+    if (cancel && cancel->cancelled()) { st.cancelled = true; return results; } // Gave up while queued on the lock
+
+    Endpoints ep = make_endpoints(srcs, dsts);
+    ResolvedConstraints rc = resolve_constraints(constraints, ep, airline_ids);
+
+    // Profile of best continuations to these destinations, built once the
+    // same destinations and date have been searched before
+    vector<string> targets(ep.targets.begin(), ep.targets.end());
+    sort(targets.begin(), targets.end());
+    string memo_key;
+    for (const auto& t : targets) memo_key += t + ',';
+    memo_key = ContinuationMemo::key(memo_key, req_date);
+
+    shared_ptr<const ContinuationProfile> profile = continuations.find(memo_key, data_version);
+    if (!profile && !(cancel && cancel->cancelled()) && continuations.admit(memo_key, data_version)) {
+        profile = ContinuationProfile::build(adj_list, ep.targets, req_date);
+        continuations.store(memo_key, data_version, profile);
+    }
 
-    unordered_map<string, int> visits;
+    // Label pool plus, per airport, the labels that survived dominance.
+    // A new label is dropped when K labels already at its airport dominate
+    // it and stopped nowhere it did not: each of those extends to a route at
+    // least as good as any route through the new one, so it can never enter
+    // the top K.
+    vector<Label> labels;
+    unordered_map<string, vector<int>> buckets;
 
-    while (!pq.empty() && results.size() < k) {
-        PathState top = pq.top();
+    // One origin label per source airport (the virtual super-source)
+    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+    for (const auto& code : ep.sources) {
+        int idx = (int)labels.size();
+        labels.push_back({0, 0, -1, 0, 0, -1, nullptr, &code});
+        buckets[code].push_back(idx);
+        pq.push({0, idx});
+        st.pushed++;
+    }
+
+    while (!pq.empty() && (int)results.size() < k) {
+        // Polled per label: a clock read is noise next to one expansion
+        if (cancel && cancel->cancelled()) { st.cancelled = true; break; }
+
+        int idx = pq.top().second;
         pq.pop();
+        st.popped++;
 
-        string u = top.current_node;
+        const string& u = *labels[idx].node;
 
-        if (u == dst) {
-            json route;
-            route["total_time"] = top.total_minutes;
-            
-            int h = top.total_minutes / 60;
-            int m = top.total_minutes % 60;
-            route["duration_fmt"] = to_string(h) + "h " + to_string(m) + "m";
-            
-            route["stops"] = (int)top.history.size() - 1;
-            
-            json segments = json::array();
-            string current_from = src; 
-
-            for(const auto& h : top.history) {
-                segments.push_back({
-                    {"airline", h.airline},
-                    {"flight_id", h.flight_id},
-                    {"from", current_from}, 
-                    {"to", h.destination},
-                    {"dep", h.dep_time},
-                    {"arr", h.arr_time},
-                    {"price", h.price},
-                    {"date", h.date}
-                });
-                current_from = h.destination;
+        if (labels[idx].legs > 0 && ep.targets.count(u)) {
+            results.push_back(label_to_route(labels, idx));
+            if (on_route) on_route(results.back());
+            continue; 
+        }
+
+        if (profile && labels[idx].legs > 0 &&
+            complete_from_memo(ep, rc, req_date, k - (int)results.size(), labels, idx, pq, st, *profile)) {
+            continue;
+        }
+
+        auto adj = adj_list.find(u);
+        if (adj == adj_list.end()) continue;
+
+        for (const auto& edge : adj->second) {
+            Label next;
+            if (!extend_label(labels, idx, edge, ep, req_date, rc, next)) continue;
+
+            // --- Dominance pruning ---
+            vector<int>& bucket = buckets[edge.destination];
+            int dominated_by = 0;
+            for (int other : bucket) {
+                if (dominates(labels[other], next) && stops_subset(labels, labels[other].parent, next.parent) &&
+                    ++dominated_by >= k) break;
             }
-            
-            route["segments"] = segments;
-            
-            int total_price = 0;
-            for(const auto& s : segments) total_price += (int)s["price"];
-            route["total_price"] = total_price;
+            if (dominated_by >= k) { st.dominated++; continue; }
 
-            results.push_back(route);
-            continue; 
+            int next_idx = (int)labels.size();
+            labels.push_back(next);
+            bucket.push_back(next_idx);
+            pq.push({next.total_minutes, next_idx});
+            st.pushed++;
         }
+    }
 
-        if (visits[u] >= k) continue;
-        visits[u]++;
+    return results;
+}
 
-        if (adj_list.find(u) != adj_list.end()) {
-            for (const auto& edge : adj_list[u]) {
-                
-                if (edge.date != req_date) continue;
+// ==========================================
+// APPROXIMATE (BEAM) SEARCH
+// ==========================================
 
-                bool cycle = false;
-                for(const auto& prev : top.history) {
-                     if (edge.destination == src || prev.destination == edge.destination) cycle = true;
-                }
-                if (cycle) continue;
+json JsonDB::find_fast_routes(const vector<string>& srcs, const vector<string>& dsts, const string& req_date, int k,
+                              int beam_width, const SearchConstraints& constraints, SearchStats* stats,
+                              const CancelToken* cancel) {
+    lock_guard<mutex> lock(db_mutex);
 
-                if (!top.history.empty()) {
-                    string prev_arr = top.history.back().arr_time;
-                    if (edge.dep_time < prev_arr) continue; 
-                }
+    SearchStats local_stats;
+    SearchStats& st = stats ? *stats : local_stats;
+    if (beam_width < 1) beam_width = 1;
+    if (cancel && cancel->cancelled()) { st.cancelled = true; return json::array(); }
 
-                vector<Edge> new_history = top.history;
-                new_history.push_back(edge);
-                
-                int layover = top.history.empty() ? 0 : 60; 
+    Endpoints ep = make_endpoints(srcs, dsts);
+    ResolvedConstraints rc = resolve_constraints(constraints, ep, airline_ids);
 
-                pq.push({
-                    top.total_minutes + edge.weight_minutes + layover, 
-                    edge.destination, 
-                    new_history
-                });
+    // Without a stop cap, stop expanding after this many legs
+    const int default_max_legs = 4;
+    int max_legs = rc.max_stops >= 0 ? rc.max_stops + 1 : default_max_legs;
+
+    // Expand one leg at a time, keeping only the beam_width cheapest partial
+    // routes per depth. Routes that reach a target are collected on the way.
+    vector<Label> labels;
+    vector<int> frontier;
+    vector<int> found;
+    for (const auto& code : ep.sources) {
+        frontier.push_back((int)labels.size());
+        labels.push_back({0, 0, -1, 0, 0, -1, nullptr, &code});
+        st.pushed++;
+    }
+
+    for (int depth = 0; depth < max_legs && !frontier.empty(); ++depth) {
+        vector<int> next_frontier;
+
+        for (int idx : frontier) {
+            if (cancel && cancel->cancelled()) { st.cancelled = true; break; }
+            st.popped++;
+            auto adj = adj_list.find(*labels[idx].node);
+            if (adj == adj_list.end()) continue;
+
+            for (const auto& edge : adj->second) {
+                Label next;
+                if (!extend_label(labels, idx, edge, ep, req_date, rc, next)) continue;
+
+                int next_idx = (int)labels.size();
+                labels.push_back(next);
+                st.pushed++;
+                if (ep.targets.count(edge.destination)) found.push_back(next_idx);
+                else next_frontier.push_back(next_idx);
             }
         }
+
+        auto by_time = [&](int a, int b) { return labels[a].total_minutes < labels[b].total_minutes; };
+        if ((int)next_frontier.size() > beam_width) {
+            nth_element(next_frontier.begin(), next_frontier.begin() + beam_width, next_frontier.end(), by_time);
+            st.dominated += next_frontier.size() - beam_width;
+            next_frontier.resize(beam_width);
+        }
+
+        // Every deeper route costs more than the cheapest frontier label, so
+        // stop once K found routes already beat all of them
+        if ((int)found.size() >= k && !next_frontier.empty()) {
+            nth_element(found.begin(), found.begin() + (k - 1), found.end(), by_time);
+            int kth = labels[found[k - 1]].total_minutes;
+            int best_open = labels[*min_element(next_frontier.begin(), next_frontier.end(), by_time)].total_minutes;
+            if (best_open >= kth) break;
+        }
+
+        if (st.cancelled) break;
+        frontier.swap(next_frontier);
     }
 
+    stable_sort(found.begin(), found.end(), [&](int a, int b) {
+        return labels[a].total_minutes < labels[b].total_minutes;
+    });
+
+    json results = json::array();
+    for (int i = 0; i < (int)found.size() && i < k; ++i) {
+        results.push_back(label_to_route(labels, found[i]));
+    }
     return results;
 }
 
@@ -285,6 +687,7 @@ void JsonDB::seed_data() {
                 f.arrival = t2;
                 f.duration = to_string(dur_h) + "h 00m";
                 f.price = 3000 + (rand() % 5000);
+                f.capacity = DEFAULT_FLIGHT_CAPACITY;
 
                 flights.push_back(f);
             }
@@ -297,15 +700,153 @@ void JsonDB::seed_data() {
     save(); 
 }
 
+// ==========================================
+// REFERENTIAL INDEXES
+// ==========================================
+// airport_pos / flight_pos map keys to array positions in `data`, and
+// outbound / inbound list the flights touching each airport. Deletes
+// close the hole in place, keeping insertion order (what /api/flights
+// lists and save() writes), and renumber the records after it: O(n), on
+// a par with the save() that follows. A cascade erases all its flights in
+// one pass. by_date_origin / by_price are the ordered indexes behind
+// find_flights().
+
+void JsonDB::build_indexes() {
+    airport_pos.clear();
+    flight_pos.clear();
+    outbound.clear();
+    inbound.clear();
+    by_date_origin.clear();
+    by_price.clear();
+
+    if (!data.contains("airports")) data["airports"] = json::array();
+    if (!data.contains("flights")) data["flights"] = json::array();
+
+    auto& airports = data["airports"];
+    for (size_t i = 0; i < airports.size(); ++i) airport_pos[airports[i]["code"]] = i;
+    auto& flights = data["flights"];
+    for (size_t i = 0; i < flights.size(); ++i) index_flight(i);
+}
+
+void JsonDB::index_flight(size_t pos) {
+    const json& f = data["flights"][pos];
+    string id = f["id"];
+    flight_pos[id] = pos;
+    outbound[f["from_code"]].insert(id);
+    inbound[f["to_code"]].insert(id);
+    by_date_origin.emplace(f.value("date", ""), f["from_code"], parse_clock_string(f.value("departure", "")), id);
+    by_price.emplace(f.value("price", 0), id);
+}
+
+void JsonDB::unindex_flight(size_t pos) {
+    const json& f = data["flights"][pos];
+    string id = f["id"];
+    flight_pos.erase(id);
+    outbound[f["from_code"]].erase(id);
+    inbound[f["to_code"]].erase(id);
+    by_date_origin.erase(make_tuple(f.value("date", ""), f["from_code"].get<string>(),
+                                    parse_clock_string(f.value("departure", "")), id));
+    by_price.erase(make_pair(f.value("price", 0), id));
+}
+
+void JsonDB::erase_flights_at(vector<size_t> positions) {
+    if (positions.empty()) return;
+    auto& arr = data["flights"];
+    sort(positions.begin(), positions.end());
+    positions.erase(unique(positions.begin(), positions.end()), positions.end());
+    for (size_t pos : positions) {
+        inventory.erase(arr[pos]["id"].get<string>());
+        unindex_flight(pos);
+    }
+
+    // Slide the survivors down over the holes, in order
+    size_t out = positions.front(), next_hole = 0;
+    for (size_t i = positions.front(); i < arr.size(); ++i) {
+        if (next_hole < positions.size() && positions[next_hole] == i) {
+            next_hole++;
+            continue;
+        }
+        if (out != i) arr[out] = std::move(arr[i]);
+        flight_pos[arr[out]["id"]] = out;
+        out++;
+    }
+    while (arr.size() > out) arr.erase(arr.size() - 1);
+}
+
+void JsonDB::erase_flight_at(size_t pos) {
+    erase_flights_at({pos});
+}
+
+void JsonDB::erase_airport_at(size_t pos) {
+    auto& arr = data["airports"];
+    airport_pos.erase(arr[pos]["code"]);
+    arr.erase(pos);
+    for (size_t i = pos; i < arr.size(); ++i) airport_pos[arr[i]["code"]] = i;
+}
+
 // ==========================================
 // API GETTERS & ADMIN OPS
 // ==========================================
 
+uint64_t JsonDB::version() {
+    lock_guard<mutex> lock(db_mutex);
+    return data_version;
+}
+
+uint64_t JsonDB::version(const string& date) {
+    lock_guard<mutex> lock(db_mutex);
+    auto it = status_versions.find(date);
+    return it == status_versions.end() ? data_version : max(data_version, it->second);
+}
+
 json JsonDB::get_all_airports() {
     lock_guard<mutex> lock(db_mutex);
     return data.value("airports", json::array());
 }
 
+json JsonDB::suggest_airports(const string& query, int limit) {
+    return suggest_index.suggest(query, limit > 0 ? limit : 0);
+}
+
+json JsonDB::airports_near(double lat, double lng, double radius_km, int limit) {
+    lock_guard<mutex> lock(db_mutex);
+    json res = json::array();
+    vector<GeoIndex::Hit> hits = radius_km > 0 ? geo.within_radius(lat, lng, radius_km)
+                                               : geo.nearest(lat, lng, limit > 0 ? limit : 0);
+    for (const auto& hit : hits) {
+        if (limit > 0 && (int)res.size() >= limit) break;
+        res.push_back({{"code", hit.code}, {"distance_km", hit.distance_km}});
+    }
+    return res;
+}
+
+vector<string> JsonDB::resolve_place(const PlaceQuery& place) {
+    lock_guard<mutex> lock(db_mutex);
+    vector<string> codes;
+
+    if (!place.city.empty()) {
+        auto it = city_airports.find(to_lower(place.city));
+        if (it != city_airports.end()) codes = it->second;
+        return codes;
+    }
+
+    if (place.radius_km <= 0 || (!place.has_coords && place.code.empty())) {
+        if (!place.code.empty()) codes.push_back(place.code);
+        return codes;
+    }
+
+    double lat = place.lat, lng = place.lng;
+    if (!place.has_coords) {
+        // Radius around an airport: look up its coordinates
+        auto it = airport_pos.find(place.code);
+        if (it == airport_pos.end()) return codes;
+        lat = data["airports"][it->second]["lat"];
+        lng = data["airports"][it->second]["long"];
+    }
+    for (const auto& hit : geo.within_radius(lat, lng, place.radius_km)) codes.push_back(hit.code);
+    return codes;
+}
+
 json JsonDB::get_flights_limited(int limit) {
     lock_guard<mutex> lock(db_mutex);
     json res = json::array();
@@ -319,62 +860,521 @@ json JsonDB::get_flights_limited(int limit) {
     return res;
 }
 
+bool JsonDB::get_flight(const string& id, FlightRecord& out) {
+    lock_guard<mutex> lock(db_mutex);
+    auto it = flight_pos.find(id);
+    if (it == flight_pos.end()) return false;
+    out.flight = data["flights"][it->second].get<Flight>();
+    out.dep_minutes = parse_clock_string(out.flight.departure);
+    out.arr_minutes = parse_clock_string(out.flight.arrival);
+    out.duration_minutes = parse_duration_string(out.flight.duration);
+    out.seats_left = inventory.available(id);
+    return true;
+}
+
+// Plan, cheapest first: a date uses the (date, origin, dep) index, an
+// origin or destination its flight set, a price sort or range the price
+// index, and anything else a scan in insertion order. Candidates already in
+// the requested order stop as soon as the page is full; otherwise the
+// (index-narrowed) matches are sorted.
+json JsonDB::find_flights(const FlightQuery& q, string* plan) {
+    lock_guard<mutex> lock(db_mutex);
+    const auto& flights = data["flights"];
+    size_t want = (size_t)max(0, q.offset) + (size_t)max(0, q.limit);
+
+    auto matches = [&](const json& f) {
+        if (!q.origin.empty() && f["from_code"] != q.origin) return false;
+        if (!q.destination.empty() && f["to_code"] != q.destination) return false;
+        if (!q.date.empty() && f.value("date", "") != q.date) return false;
+        if (!q.airline.empty() && f.value("airline", "") != q.airline) return false;
+        int price = f.value("price", 0);
+        if (q.min_price >= 0 && price < q.min_price) return false;
+        if (q.max_price >= 0 && price > q.max_price) return false;
+        return true;
+    };
+
+    vector<size_t> hits; // Positions in data["flights"]
+    bool ordered = q.sort == FlightQuery::NONE; // Are hits already in the requested order?
+    // Feeds one candidate id; returns false once enough ordered hits are in
+    auto take = [&](const string& id) {
+        size_t pos = flight_pos.at(id);
+        if (matches(flights[pos])) hits.push_back(pos);
+        return !(ordered && hits.size() >= want);
+    };
+
+    if (!q.date.empty()) {
+        if (plan) *plan = q.origin.empty() ? "date" : "date+origin";
+        ordered = ordered || (q.sort == FlightQuery::DEPARTURE && !q.origin.empty() && !q.descending);
+        auto lo = by_date_origin.lower_bound(make_tuple(q.date, q.origin, INT_MIN, string()));
+        for (auto it = lo; it != by_date_origin.end(); ++it) {
+            if (get<0>(*it) != q.date || (!q.origin.empty() && get<1>(*it) != q.origin)) break;
+            if (!take(get<3>(*it))) break;
+        }
+    } else if (!q.origin.empty() || !q.destination.empty()) {
+        // Unordered sets: walk the smaller side and sort what matches
+        static const unordered_set<string> none;
+        auto flights_at = [&](const unordered_map<string, unordered_set<string>>& index, const string& code)
+            -> const unordered_set<string>& {
+            auto it = index.find(code);
+            return it == index.end() ? none : it->second;
+        };
+        const auto& from_ids = flights_at(outbound, q.origin);
+        const auto& to_ids = flights_at(inbound, q.destination);
+        bool use_origin = !q.origin.empty() && (q.destination.empty() || from_ids.size() <= to_ids.size());
+        if (plan) *plan = use_origin ? "origin" : "destination";
+        ordered = false;
+        for (const auto& id : use_origin ? from_ids : to_ids) take(id);
+    } else if (q.sort == FlightQuery::PRICE || q.min_price >= 0 || q.max_price >= 0) {
+        if (plan) *plan = "price";
+        ordered = ordered || q.sort == FlightQuery::PRICE;
+        auto lo = by_price.lower_bound(make_pair(q.min_price >= 0 ? q.min_price : INT_MIN, string()));
+        auto hi = q.max_price >= 0 && q.max_price < INT_MAX ? by_price.lower_bound(make_pair(q.max_price + 1, string()))
+                                                            : by_price.end();
+        if (q.descending && q.sort == FlightQuery::PRICE) {
+            for (auto it = hi; it != lo;) if (!take((--it)->second)) break;
+        } else {
+            for (auto it = lo; it != hi; ++it) if (!take(it->second)) break;
+        }
+    } else {
+        if (plan) *plan = "scan";
+        for (size_t pos = 0; pos < flights.size(); ++pos) {
+            if (!matches(flights[pos])) continue;
+            hits.push_back(pos);
+            if (ordered && hits.size() >= want) break;
+        }
+    }
+
+    if (!ordered) {
+        auto key = [&](size_t pos) {
+            const json& f = flights[pos];
+            if (q.sort == FlightQuery::PRICE) return make_tuple(f.value("price", 0), string(), 0);
+            return make_tuple(0, f.value("date", ""), parse_clock_string(f.value("departure", "")));
+        };
+        auto less = [&](size_t a, size_t b) {
+            if (q.sort == FlightQuery::NONE) return a < b;
+            auto ka = key(a), kb = key(b);
+            if (ka != kb) return q.descending ? kb < ka : ka < kb;
+            return flights[a]["id"] < flights[b]["id"]; // Stable across calls
+        };
+        size_t keep = min(want, hits.size());
+        partial_sort(hits.begin(), hits.begin() + keep, hits.end(), less);
+        hits.resize(keep);
+    }
+
+    json res = json::array();
+    for (size_t i = (size_t)max(0, q.offset); i < hits.size() && i < want; ++i) res.push_back(flights[hits[i]]);
+    return res;
+}
+
+void JsonDB::set_change_listener(function<void(const ScheduleChange&)> listener) {
+    lock_guard<mutex> lock(db_mutex);
+    change_listener = std::move(listener);
+}
+
+FlightChange JsonDB::describe_flight(const json& f) {
+    return {f.value("id", ""), f.value("from_code", ""), f.value("to_code", ""), f.value("date", ""),
+            f.value("airline", ""), parse_duration_string(f.value("duration", "")), f.value("price", 0)};
+}
+
+void JsonDB::publish(const ScheduleChange& change) {
+    if (change_listener) change_listener(change);
+}
+
 bool JsonDB::add_airport(const Airport& apt) {
     lock_guard<mutex> lock(db_mutex);
-    if (!data.contains("airports")) data["airports"] = json::array();
-    for(auto& x : data["airports"]) if(x["code"] == apt.code) return false;
-    json j = apt; data["airports"].push_back(j); save(); return true;
+    if (airport_pos.count(apt.code)) return false;
+    json j = apt;
+    airport_pos[apt.code] = data["airports"].size();
+    data["airports"].push_back(j); save();
+    suggest_index.add(j);
+    publish({{apt.code}, {}});
+    return true;
 }
 
 bool JsonDB::delete_airport(const string& code) {
     lock_guard<mutex> lock(db_mutex);
-    if(!data.contains("airports")) return false;
-    auto& arr = data["airports"];
-    for(auto it = arr.begin(); it != arr.end(); ++it) {
-        if((*it)["code"] == code) { arr.erase(it); save(); return true; }
+    auto it = airport_pos.find(code);
+    if (it == airport_pos.end()) return false;
+
+    // Cascade: drop every flight into or out of the airport
+    ScheduleChange change{{code}, {}};
+    vector<string> doomed(outbound[code].begin(), outbound[code].end());
+    doomed.insert(doomed.end(), inbound[code].begin(), inbound[code].end());
+    vector<size_t> positions;
+    for (const auto& id : doomed) {
+        auto f = flight_pos.find(id);
+        if (f == flight_pos.end()) continue;
+        change.flights.push_back(describe_flight(data["flights"][f->second]));
+        positions.push_back(f->second);
     }
-    return false;
+    erase_flights_at(move(positions));
+    outbound.erase(code);
+    inbound.erase(code);
+
+    erase_airport_at(it->second);
+    save();
+    suggest_index.remove(code);
+    publish(change);
+    return true;
 }
 
 bool JsonDB::update_airport(const string& code, const json& new_data) {
     lock_guard<mutex> lock(db_mutex);
-    if (!data.contains("airports")) return false;
-    for (auto& apt : data["airports"]) {
-        if (apt["code"] == code) {
-            for (auto& el : new_data.items()) apt[el.key()] = el.value();
-            save(); return true;
+    auto it = airport_pos.find(code);
+    if (it == airport_pos.end()) return false;
+    size_t pos = it->second;
+
+    string new_code = new_data.contains("code") && new_data["code"].is_string() ? new_data["code"].get<string>() : code;
+    if (new_code != code && airport_pos.count(new_code)) return false;
+
+    json& apt = data["airports"][pos];
+    for (auto& el : new_data.items()) apt[el.key()] = el.value();
+
+    if (new_code != code) {
+        // Cascade the rename to every flight that references the airport
+        auto& flights = data["flights"];
+        for (const auto& id : outbound[code]) flights[flight_pos[id]]["from_code"] = new_code;
+        for (const auto& id : inbound[code]) flights[flight_pos[id]]["to_code"] = new_code;
+        outbound[new_code] = std::move(outbound[code]);
+        inbound[new_code] = std::move(inbound[code]);
+        outbound.erase(code);
+        inbound.erase(code);
+        airport_pos.erase(code);
+        airport_pos[new_code] = pos;
+    }
+
+    save();
+    suggest_index.remove(code);
+    suggest_index.add(apt);
+    publish({new_code != code ? vector<string>{code, new_code} : vector<string>{code}, {}});
+    return true;
+}
+
+bool JsonDB::refresh_columns() {
+    if (columns && columns_version == data_version) return false;
+    columns = make_shared<const FlightColumns>(FlightColumns::from_json(data["flights"]));
+    columns_version = data_version;
+    return true;
+}
+
+json JsonDB::analytics(const AnalyticsQuery& query) {
+    shared_ptr<const FlightColumns> snapshot;
+    {
+        lock_guard<mutex> lock(db_mutex);
+        refresh_columns();
+        snapshot = columns;
+    }
+    return run_analytics(*snapshot, query);
+}
+
+bool JsonDB::prepare_analytics() {
+    lock_guard<mutex> lock(db_mutex);
+    return refresh_columns();
+}
+
+SeatInventory::Result JsonDB::book_seats(const vector<string>& flight_ids, int seats, string* failed_id) {
+    shared_lock<shared_mutex> lock(booking_mutex);
+    SeatInventory::Result r = inventory.reserve(flight_ids, seats, failed_id);
+    if (r == SeatInventory::Result::OK) journal_booking(flight_ids, seats);
+    return r;
+}
+
+bool JsonDB::commit_hold(const function<bool(vector<string>&, int&)>& take) {
+    shared_lock<shared_mutex> lock(booking_mutex);
+    vector<string> flight_ids;
+    int seats = 0;
+    if (!take(flight_ids, seats)) return false;
+    journal_booking(flight_ids, seats);
+    return true;
+}
+
+void JsonDB::set_held_seats(function<unordered_map<string, int>()> held) {
+    unique_lock<shared_mutex> lock(booking_mutex);
+    held_seats = move(held);
+}
+
+void JsonDB::journal_booking(const vector<string>& flight_ids, int seats) {
+    string line = json{{"flights", flight_ids}, {"seats", seats}}.dump() + "\n";
+    lock_guard<mutex> lock(booking_append);
+    if (!bookings.is_open()) bookings.open(bookings_path, ios::app);
+    bookings << line;
+    bookings.flush();
+    if (!bookings) cerr << "[ERROR] Could not journal a booking to " << bookings_path << endl;
+    booking_events++;
+}
+
+void JsonDB::replay_bookings() {
+    ifstream in(bookings_path);
+    string line;
+    size_t bad = 0;
+    while (getline(in, line)) {
+        if (line.empty()) continue;
+        auto j = json::parse(line, nullptr, false);
+        vector<string> flight_ids;
+        int seats = 0;
+        if (j.is_object() && j.contains("flights") && j["flights"].is_array()) {
+            for (const auto& id : j["flights"]) {
+                if (id.is_string()) flight_ids.push_back(id);
+            }
+            seats = j.value("seats", 0);
         }
+        // A flight deleted or resized since may refuse it; the rest still count
+        if (flight_ids.empty() || seats < 1 || inventory.reserve(flight_ids, seats) != SeatInventory::Result::OK) bad++;
+        booking_events++;
+    }
+    if (booking_events) {
+        cout << "[INFO] Replayed " << booking_events - bad << " bookings";
+        if (bad) cout << " (" << bad << " skipped)";
+        cout << endl;
+    }
+}
+
+void JsonDB::release_seats(const vector<string>& flight_ids, int seats) {
+    inventory.release(flight_ids, seats);
+}
+
+json JsonDB::seat_availability(const vector<string>& flight_ids) {
+    json res = json::object();
+    for (const auto& id : flight_ids) {
+        int left = inventory.available(id);
+        if (left >= 0) res[id] = left;
     }
-    return false;
+    return res;
 }
 
-bool JsonDB::add_flight(const Flight& fl) {
+json JsonDB::price_history(const string& id, int64_t from, int64_t to, size_t limit) {
+    int current = -1;
+    {
+        lock_guard<mutex> lock(db_mutex);
+        auto it = flight_pos.find(id);
+        if (it != flight_pos.end()) current = data["flights"][it->second].value("price", 0);
+    }
+
+    int initial;
+    vector<PriceHistory::Point> points;
+    bool known = price_log.query(id, from, to, limit, initial, points);
+    if (!known && current < 0) return nullptr;
+
+    json changes = json::array();
+    for (const auto& p : points) changes.push_back({{"time", p.time}, {"price", p.price}});
+    json res = {{"id", id}, {"initial_price", known ? initial : current}, {"changes", changes}};
+    res["current_price"] = current >= 0 ? json(current) : json(nullptr); // null once deleted
+    return res;
+}
+
+JsonDB::AddFlightResult JsonDB::add_flight(const Flight& fl) {
     lock_guard<mutex> lock(db_mutex);
-    if (!data.contains("flights")) data["flights"] = json::array();
-    for (const auto& existing : data["flights"]) {
-        if (existing.value("id", "") == fl.id) return false;
+    if (flight_pos.count(fl.id)) return AddFlightResult::DUPLICATE;
+    if (fl.from_code == fl.to_code || !airport_pos.count(fl.from_code) || !airport_pos.count(fl.to_code)) {
+        return AddFlightResult::UNKNOWN_AIRPORT;
     }
-    json j = fl; data["flights"].push_back(j); save(); return true;
+    json j = fl; data["flights"].push_back(j);
+    index_flight(data["flights"].size() - 1);
+    save();
+    publish({{}, {describe_flight(j)}});
+    return AddFlightResult::ADDED;
 }
 
 bool JsonDB::delete_flight(const string& id) {
     lock_guard<mutex> lock(db_mutex);
-    if(!data.contains("flights")) return false;
-    auto& arr = data["flights"];
-    for(auto it = arr.begin(); it != arr.end(); ++it) {
-        if((*it)["id"] == id) { arr.erase(it); save(); return true; }
+    auto it = flight_pos.find(id);
+    if (it == flight_pos.end()) return false;
+    ScheduleChange change{{}, {describe_flight(data["flights"][it->second])}};
+    erase_flight_at(it->second);
+    save();
+    publish(change);
+    return true;
+}
+
+JsonDB::UpdateFlightResult JsonDB::update_flight(const string& id, const json& new_data) {
+    lock_guard<mutex> lock(db_mutex);
+    auto it = flight_pos.find(id);
+    if (it == flight_pos.end()) return UpdateFlightResult::NOT_FOUND;
+    size_t pos = it->second;
+    json& fl = data["flights"][pos];
+
+    // Model fields keep their types: index_flight() and get<Flight>() would
+    // throw on anything else, halfway through reindexing
+    if (!new_data.is_object()) return UpdateFlightResult::INVALID;
+    for (const char* key : {"id", "airline", "from_code", "to_code", "date", "departure", "arrival", "duration"}) {
+        if (new_data.contains(key) && !new_data[key].is_string()) return UpdateFlightResult::INVALID;
+    }
+    for (const char* key : {"price", "capacity"}) {
+        if (new_data.contains(key) && !new_data[key].is_number_integer()) return UpdateFlightResult::INVALID;
+    }
+    if (new_data.contains("capacity") && new_data["capacity"].get<int64_t>() < 0) return UpdateFlightResult::INVALID;
+
+    // Ids are fixed (seat counters and holds are keyed by them), and the
+    // endpoints must stay valid airports
+    if (new_data.contains("id") && new_data["id"] != id) return UpdateFlightResult::INVALID;
+    string from = new_data.value("from_code", fl["from_code"].get<string>());
+    string to = new_data.value("to_code", fl["to_code"].get<string>());
+    if (from == to || !airport_pos.count(from) || !airport_pos.count(to)) return UpdateFlightResult::INVALID;
+
+    // A capacity change moves the seats left by the same amount
+    if (new_data.contains("capacity")) {
+        int old_capacity = fl.value("capacity", DEFAULT_FLIGHT_CAPACITY);
+        inventory.adjust(id, new_data["capacity"].get<int>() - old_capacity);
+    }
+
+    ScheduleChange change{{}, {describe_flight(fl)}};
+    int old_price = fl.value("price", 0);
+    unindex_flight(pos);
+    for (auto& el : new_data.items()) fl[el.key()] = el.value();
+    index_flight(pos);
+    if (fl["price"].is_number_integer() && fl["price"].get<int>() != old_price) {
+        price_log.record(id, old_price, fl["price"], (int64_t)time(nullptr));
+    }
+    change.flights.push_back(describe_flight(fl));
+    save();
+    publish(change);
+    return UpdateFlightResult::UPDATED;
+}
+
+// ==========================================
+// FLIGHT STATUS
+// ==========================================
+// Delays move "departure" / "arrival" to the scheduled times (kept in
+// "scheduled_departure" / "scheduled_arrival" while delayed) plus the delay;
+// cancellations set "status". Both are patched into the live Edge through
+// edge_by_id, so no graph rebuild is needed. A batch stamps the dates it
+// touched in status_versions, retiring cached searches for those dates
+// only, and drops their continuation profiles. A delay must leave the
+// departure and the arrival on their scheduled days, since edges carry
+// clock times only.
+
+static string clock_string(int minutes) {
+    char buf[16]; // -Wformat-truncation sizes the fields for any int
+    snprintf(buf, sizeof(buf), "%02d:%02d", minutes / 60 % 24, minutes % 60);
+    return buf;
+}
+
+string JsonDB::apply_status_locked(const FlightStatusEvent& ev) {
+    auto it = flight_pos.find(ev.id);
+    if (it == flight_pos.end()) return "Unknown flight";
+    size_t pos = it->second;
+    json& fl = data["flights"][pos];
+    auto edge = edge_by_id.find(ev.id);
+    if (edge == edge_by_id.end()) return "Flight is not in the graph";
+    Edge& e = *edge->second;
+
+    if (ev.delay_minutes >= 0) {
+        string sched_dep = fl.value("scheduled_departure", fl.value("departure", ""));
+        string sched_arr = fl.value("scheduled_arrival", fl.value("arrival", ""));
+        int dep = parse_clock_string(sched_dep) + ev.delay_minutes;
+        int arr = parse_clock_string(sched_arr) + ev.delay_minutes;
+        // Both clocks then move by the same amount without wrapping, so a
+        // scheduled overnight arrival (clock at or before the departure)
+        // stays overnight and a same-day one stays same-day
+        if (dep >= 24 * 60) return "Delay moves the departure to another day";
+        if (arr >= 24 * 60) return "Delay moves the arrival to another day";
+
+        // Only the listing index keyed by departure time moves
+        string date = fl.value("date", ""), from = fl["from_code"];
+        by_date_origin.erase(make_tuple(date, from, parse_clock_string(fl.value("departure", "")), ev.id));
+        by_date_origin.emplace(date, from, dep, ev.id);
+        if (ev.delay_minutes == 0) {
+            fl.erase("scheduled_departure");
+            fl.erase("scheduled_arrival");
+            fl.erase("delay_minutes");
+        } else {
+            fl["scheduled_departure"] = sched_dep;
+            fl["scheduled_arrival"] = sched_arr;
+            fl["delay_minutes"] = ev.delay_minutes;
+        }
+        fl["departure"] = clock_string(dep);
+        fl["arrival"] = clock_string(arr);
+
+        e.dep_time = fl["departure"];
+        e.arr_time = fl["arrival"];
+        e.dep_minutes = dep;
+        e.arr_minutes = arr;
+    }
+    if (ev.cancelled >= 0) {
+        e.cancelled = ev.cancelled == 1;
+        if (e.cancelled) fl["status"] = "cancelled";
+        else fl.erase("status");
+    }
+    return "";
+}
+
+static json status_to_json(const FlightStatusEvent& ev) {
+    json j = {{"id", ev.id}};
+    if (ev.delay_minutes >= 0) j["delay_minutes"] = ev.delay_minutes;
+    if (ev.cancelled >= 0) j["cancelled"] = ev.cancelled;
+    return j;
+}
+
+size_t JsonDB::apply_status(const vector<FlightStatusEvent>& events, vector<string>& errors) {
+    lock_guard<mutex> lock(db_mutex);
+    errors.assign(events.size(), "");
+    ScheduleChange change;
+    string lines;
+    size_t applied = 0;
+    set<string> dates;
+    for (size_t i = 0; i < events.size(); ++i) {
+        errors[i] = apply_status_locked(events[i]);
+        if (!errors[i].empty()) continue;
+        applied++;
+        lines += status_to_json(events[i]).dump() + "\n";
+        const json& fl = data["flights"][flight_pos[events[i].id]];
+        dates.insert(fl.value("date", ""));
+        change.flights.push_back(describe_flight(fl));
     }
-    return false;
+    if (applied == 0) return 0;
+
+    // One append per batch; the file itself is rewritten only by save()
+    if (!journal.is_open()) journal.open(journal_path, ios::app);
+    journal << lines;
+    journal.flush();
+    journal_events += applied;
+
+    uint64_t stamp = ++version_clock;
+    for (const auto& date : dates) {
+        status_versions[date] = stamp;
+        continuations.erase_date(date);
+    }
+    publish(change);
+    return applied;
 }
 
-bool JsonDB::update_flight(const string& id, const json& new_data) {
+size_t JsonDB::journal_size() {
     lock_guard<mutex> lock(db_mutex);
-    if (!data.contains("flights")) return false;
-    for (auto& fl : data["flights"]) {
-        if (fl["id"] == id) {
-            for (auto& el : new_data.items()) fl[el.key()] = el.value();
-            save(); return true;
+    return journal_events;
+}
+
+size_t JsonDB::booking_journal_size() {
+    lock_guard<mutex> lock(booking_append);
+    return booking_events;
+}
+
+size_t JsonDB::fold_journal() {
+    lock_guard<mutex> lock(db_mutex);
+    size_t folded = journal_events + booking_journal_size();
+    if (folded) save();
+    return folded;
+}
+
+void JsonDB::replay_journal() {
+    ifstream in(journal_path);
+    string line;
+    size_t bad = 0;
+    while (getline(in, line)) {
+        if (line.empty()) continue;
+        auto j = json::parse(line, nullptr, false);
+        FlightStatusEvent ev;
+        if (j.is_object() && j.contains("id") && j["id"].is_string()) {
+            ev.id = j["id"];
+            ev.delay_minutes = j.value("delay_minutes", -1);
+            ev.cancelled = j.value("cancelled", -1);
         }
+        // Events for flights deleted since are dropped at the next save()
+        if (ev.id.empty() || !apply_status_locked(ev).empty()) bad++;
+        journal_events++;
     }
-    return false;
-}
\ No newline at end of file
+    if (journal_events) {
+        cout << "[INFO] Replayed " << journal_events - bad << " flight status events";
+        if (bad) cout << " (" << bad << " skipped)";
+        cout << endl;
+    }
+}
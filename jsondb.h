@@ -2,11 +2,27 @@
 #define JSONDB_H
 
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <set>
+#include <tuple>
 #include <mutex>    // <--- REQUIRED for mutex
+#include <shared_mutex>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <nlohmann/json.hpp>
 #include "Models.h"
+#include "geoindex.h"
+#include "suggest_index.h"
+#include "seat_inventory.h"
+#include "analytics.h"
+#include "continuation_memo.h"
+#include "cancel_token.h"
+#include "price_history.h"
 
 using json = nlohmann::json;
 
@@ -18,8 +34,96 @@ struct Edge {
     std::string date;        
     std::string dep_time;    
     std::string arr_time;    
+    int dep_minutes;         // dep_time as minutes after midnight
+    int arr_minutes;         // arr_time as minutes after midnight
     int price;
     std::string airline;
+    int airline_id;          // Interned airline index (for constraint masks)
+    const std::atomic<int>* seats; // Live seat counter from SeatInventory
+    bool cancelled;          // Set by the status feed; searches skip it
+};
+
+// Optional filters for the route search, enforced while expanding edges
+// so the K results returned all satisfy them.
+struct SearchConstraints {
+    std::vector<std::string> airlines; // Allowed airlines (empty = any)
+    int max_price = -1;                // Cap on total fare (-1 = no cap)
+    int max_stops = -1;                // Cap on intermediate stops (-1 = no cap)
+    std::vector<std::string> avoid;    // Airports the route must not touch
+    std::vector<std::string> via;      // Airports the route must stop at (at most MAX_VIA_AIRPORTS)
+    int seats = 1;                     // Free seats needed on every leg (0 = ignore inventory)
+
+    static const size_t MAX_VIA_AIRPORTS = 32; // One bit each in a label's via mask
+
+    // Distinct via airports within MAX_VIA_AIRPORTS; callers reject the rest
+    bool via_fits() const {
+        std::vector<std::string> codes = via;
+        std::sort(codes.begin(), codes.end());
+        return (size_t)(std::unique(codes.begin(), codes.end()) - codes.begin()) <= MAX_VIA_AIRPORTS;
+    }
+};
+
+// One end of a search: a single airport, every airport of a city, or every
+// airport within radius_km of an airport (code) or of a coordinate
+struct PlaceQuery {
+    std::string code;
+    std::string city;
+    double radius_km = 0;
+    bool has_coords = false;
+    double lat = 0;
+    double lng = 0;
+};
+
+// Work done by one search, for profiling the pruning rules
+struct SearchStats {
+    size_t pushed = 0;     // Labels queued
+    size_t popped = 0;     // Labels expanded or accepted at the destination
+    size_t dominated = 0;  // Labels pruned by dominance (or dropped from the beam)
+    size_t memo_hits = 0;  // Hub labels completed from the continuation memo
+    size_t memo_misses = 0;
+    bool cancelled = false; // Stopped early by its CancelToken; results are partial
+};
+
+// A stored flight with its clock and block times already in minutes
+struct FlightRecord {
+    Flight flight;
+    int dep_minutes, arr_minutes, duration_minutes;
+    int seats_left; // -1 if the inventory does not know the flight
+};
+
+// One flight record touched by an admin op, as it was before or after
+struct FlightChange {
+    std::string id, from, to, date, airline;
+    int minutes; // Block time
+    int price;
+};
+
+// What one admin op changed, for listeners that keep derived results
+struct ScheduleChange {
+    std::vector<std::string> airports; // Codes of airport records added, removed or edited
+    std::vector<FlightChange> flights; // Flight records before and / or after the op
+};
+
+// A live status update for one flight (see status_ingest.h). Delays count
+// from the scheduled times, so applying an event twice is harmless.
+struct FlightStatusEvent {
+    std::string id;
+    int delay_minutes = -1; // Minutes behind schedule (-1 = times unchanged)
+    int cancelled = -1;     // 1 = cancelled, 0 = reinstated, -1 = unchanged
+};
+
+// Receives each route of a search as soon as it is final
+typedef std::function<void(const json& route)> RouteCallback;
+
+// Filters and ordering for the flight listing. Empty strings and -1 mean
+// "any"; sort NONE returns matches in whatever order is cheapest.
+struct FlightQuery {
+    std::string origin, destination, date, airline;
+    int min_price = -1, max_price = -1;
+    enum Sort { NONE, PRICE, DEPARTURE } sort = NONE;
+    bool descending = false;
+    int limit = 10;
+    int offset = 0;
 };
 
 class JsonDB {
@@ -30,30 +134,193 @@ private:
 
     // The Graph: Source Code -> List of Flights
     std::unordered_map<std::string, std::vector<Edge>> adj_list;
+    std::unordered_map<std::string, Edge*> edge_by_id; // Into adj_list, until the next build_graph()
+    std::unordered_map<std::string, int> airline_ids; // Airline name -> Edge::airline_id
+
+    // Airport lookups by location, rebuilt with the graph
+    GeoIndex geo;
+    std::unordered_map<std::string, std::vector<std::string>> city_airports; // Lower-cased city -> codes
+
+    // Autocomplete index, maintained incrementally by the airport admin ops
+    // (has its own lock, so it is not guarded by db_mutex)
+    AirportSuggestIndex suggest_index;
+
+    // Seats left per flight. Outlives graph rebuilds and is updated without
+    // db_mutex; counts are written back to the flight records by save().
+    SeatInventory inventory;
+
+    // Fare changes made through update_flight, in <filename>.prices
+    // (has its own lock; open blocks are flushed by save())
+    PriceHistory price_log;
+
+    // Set from version_clock by every save(); lets derived structures
+    // notice stale data. Status batches only touch times and cancellations
+    // of one date's flights, so they stamp status_versions instead: the
+    // analytics columns and other dates' cached searches and profiles
+    // stay valid.
+    uint64_t version_clock = 0;
+    uint64_t data_version = 0;
+    std::unordered_map<std::string, uint64_t> status_versions; // Date -> version_clock at its last status batch
+
+    // Continuation profiles shared by exact searches to the same
+    // destinations and date, tagged with data_version (see jsondb.cpp)
+    ContinuationMemo continuations;
+
+    // Columnar snapshot for analytics, rebuilt lazily when data_version moves
+    std::shared_ptr<const FlightColumns> columns;
+    uint64_t columns_version = 0;
+    bool refresh_columns(); // Caller holds db_mutex; true if rebuilt
+
+    // Referential indexes over `data` (see jsondb.cpp)
+    std::unordered_map<std::string, size_t> airport_pos; // Code -> index in data["airports"]
+    std::unordered_map<std::string, size_t> flight_pos;  // Id -> index in data["flights"]
+    std::unordered_map<std::string, std::unordered_set<std::string>> outbound; // Code -> flight ids from it
+    std::unordered_map<std::string, std::unordered_set<std::string>> inbound;  // Code -> flight ids to it
+
+    // Ordered indexes for the flight listing, keyed by flight id
+    std::set<std::tuple<std::string, std::string, int, std::string>> by_date_origin; // (date, origin, dep minutes, id)
+    std::set<std::pair<int, std::string>> by_price;                                  // (price, id)
+
+    void build_indexes();
+    void index_flight(size_t pos);
+    void unindex_flight(size_t pos);
+    void erase_flights_at(std::vector<size_t> positions); // Keeps the rest in order
+    void erase_flight_at(size_t pos);
+    void erase_airport_at(size_t pos);
+
+    // Told about every admin op after its save(), still under db_mutex,
+    // so it must not call back into JsonDB
+    std::function<void(const ScheduleChange&)> change_listener;
+    FlightChange describe_flight(const json& f);
+    void publish(const ScheduleChange& change);
+
+    // Status events applied since the last save(), one JSON line each in
+    // <filename>.status; replayed on startup, emptied by save()
+    std::string journal_path;
+    std::ofstream journal;
+    size_t journal_events = 0;
+    std::string apply_status_locked(const FlightStatusEvent& event);
+    void replay_journal();
+
+    // Bookings made since the last save(), one JSON line each in
+    // <filename>.bookings; replayed on startup, emptied by save(). Bookings
+    // share booking_mutex (they still run concurrently); save() takes it
+    // exclusively while it writes the seat counts and empties the journal,
+    // so no booking is both in the file and in the journal.
+    std::shared_mutex booking_mutex;
+    std::mutex booking_append; // Orders the appends of concurrent bookings
+    std::string bookings_path;
+    std::ofstream bookings;
+    size_t booking_events = 0;
+    std::function<std::unordered_map<std::string, int>()> held_seats;
+    void journal_booking(const std::vector<std::string>& flight_ids, int seats); // Caller shares booking_mutex
+    void replay_bookings();
 
     void seed_data();
     void save();
     void build_graph(); 
     int parse_duration_string(const std::string& dur);
+    int parse_clock_string(const std::string& hhmm);
 
 public:
     JsonDB(const std::string& fname);
 
     // Read APIs
+    uint64_t version(); // Changes with every save()
+    uint64_t version(const std::string& date); // Also with status updates to the date's flights; tags cached searches
     json get_all_airports();
     json get_flights_limited(int limit);
+    bool get_flight(const std::string& id, FlightRecord& out); // false if unknown
+
+    // Flight listing answered from the ordered indexes when a filter or sort
+    // key allows it; `plan` (optional) names the index that was used
+    json find_flights(const FlightQuery& query, std::string* plan = nullptr);
     
-    // Smart Search
-    json find_smart_routes(const std::string& src, const std::string& dst, const std::string& date, int k = 5);
+    json airports_near(double lat, double lng, double radius_km, int limit);
+    json suggest_airports(const std::string& query, int limit);
+
+    // Airport codes matching a PlaceQuery (empty if nothing matches)
+    std::vector<std::string> resolve_place(const PlaceQuery& place);
+
+    // Smart Search. The multi-airport form searches from all of srcs to any
+    // of dsts at once, as if they were one virtual origin and destination.
+    // Routes are found cheapest first; on_route (called under db_mutex, so
+    // it must not block) sees each one the moment it is found. A tripped
+    // cancel token ends the search at the next label it would expand.
+    json find_smart_routes(const std::vector<std::string>& srcs, const std::vector<std::string>& dsts,
+                           const std::string& date, int k = 5,
+                           const SearchConstraints& constraints = SearchConstraints(),
+                           SearchStats* stats = nullptr, const RouteCallback& on_route = nullptr,
+                           const CancelToken* cancel = nullptr);
+    json find_smart_routes(const std::string& src, const std::string& dst, const std::string& date, int k = 5,
+                           const SearchConstraints& constraints = SearchConstraints(),
+                           SearchStats* stats = nullptr) {
+        return find_smart_routes(std::vector<std::string>{src}, std::vector<std::string>{dst}, date, k, constraints, stats);
+    }
+
+    // Approximate search: beam search that keeps the beam_width cheapest
+    // partial routes per leg. Bounded work per query, may miss some of the
+    // exact top K.
+    json find_fast_routes(const std::vector<std::string>& srcs, const std::vector<std::string>& dsts,
+                          const std::string& date, int k = 5, int beam_width = 32,
+                          const SearchConstraints& constraints = SearchConstraints(),
+                          SearchStats* stats = nullptr, const CancelToken* cancel = nullptr);
+    json find_fast_routes(const std::string& src, const std::string& dst, const std::string& date, int k = 5,
+                          int beam_width = 32, const SearchConstraints& constraints = SearchConstraints(),
+                          SearchStats* stats = nullptr) {
+        return find_fast_routes(std::vector<std::string>{src}, std::vector<std::string>{dst}, date, k, beam_width,
+                                constraints, stats);
+    }
 
     // Admin APIs
     bool add_airport(const Airport& airport);
     bool delete_airport(const std::string& code);
     bool update_airport(const std::string& code, const json& new_data);
     
-    bool add_flight(const Flight& flight);
+    // Booking: reserve or return seats on every flight of an itinerary,
+    // all-or-nothing, without taking db_mutex. A booking is in the bookings
+    // journal before book_seats() returns, so it survives a restart.
+    SeatInventory::Result book_seats(const std::vector<std::string>& flight_ids, int seats, std::string* failed_id);
+    // Journals the seats of a confirmed hold: `take` (HoldManager::confirm)
+    // removes the hold and reports its flights and seats. Its result.
+    bool commit_hold(const std::function<bool(std::vector<std::string>&, int&)>& take);
+    // Seats taken by outstanding holds, per flight. save() writes them back
+    // as free, since holds do not outlive the process.
+    void set_held_seats(std::function<std::unordered_map<std::string, int>()> held);
+    void release_seats(const std::vector<std::string>& flight_ids, int seats);
+    json seat_availability(const std::vector<std::string>& flight_ids);
+
+    // Group-by fare analytics; the scan runs on a snapshot, outside db_mutex
+    json analytics(const AnalyticsQuery& query);
+    SeatInventory& seats() { return inventory; }
+
+    // Recorded fare changes of a flight between two unix times (the newest
+    // `limit`), with its price before them and now; null if the flight is
+    // unknown and has no history
+    json price_history(const std::string& id, int64_t from, int64_t to, size_t limit);
+    PriceHistory& prices() { return price_log; }
+
+    void set_change_listener(std::function<void(const ScheduleChange&)> listener);
+
+    enum class AddFlightResult { ADDED, DUPLICATE, UNKNOWN_AIRPORT };
+    AddFlightResult add_flight(const Flight& flight);
     bool delete_flight(const std::string& id);
-    bool update_flight(const std::string& id, const json& new_data);
+    // INVALID: a field of the wrong type, an id change or a bad endpoint
+    enum class UpdateFlightResult { UPDATED, NOT_FOUND, INVALID };
+    UpdateFlightResult update_flight(const std::string& id, const json& new_data);
+
+    // Applies status events in place (edge times, cancelled flag, flight
+    // records) without a save() or graph rebuild, all under one lock, and
+    // appends them to the status journal. errors[i] is "" when events[i]
+    // was applied. Returns how many were.
+    size_t apply_status(const std::vector<FlightStatusEvent>& events, std::vector<std::string>& errors);
+    size_t journal_size(); // Events in the status journal
+    size_t booking_journal_size(); // Bookings in the bookings journal
+    size_t fold_journal(); // Saves, which empties both journals; returns the entries folded in
+
+    // Rebuilds the analytics snapshot if the data moved since, so the next
+    // analytics() call does not pay for it. True if it was rebuilt.
+    bool prepare_analytics();
 };
 
 #endif
\ No newline at end of file
@@ -1,8 +1,34 @@
 #include "crow.h"
+#include "async_task.h"
 #include "jsondb.h"
+#include "hold_manager.h"
+#include "maintenance.h"
+#include "popular_queries.h"
+#include "search_cache.h"
+#include "search_params.h"
+#include "search_prefetch.h"
+#include "standing_queries.h"
+#include "status_ingest.h"
+#ifndef _WIN32
+#include "binary_server.h"
+#include "unix_socket_server.h"
+#endif
+#include "metrics.h"
+#include "rate_limiter.h"
 #include "Models.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -25,10 +51,403 @@ struct CORSHandler {
     }
 };
 
-JsonDB db("flight_database.json");
+// Speculative prefetch settings: FLIGHT_PREFETCH=0 turns it off,
+// FLIGHT_PREFETCH_BUDGET caps speculative searches per second
+static PrefetchConfig prefetch_config() {
+    PrefetchConfig config;
+    if (const char* v = std::getenv("FLIGHT_PREFETCH")) config.enabled = std::string(v) != "0";
+    if (const char* v = std::getenv("FLIGHT_PREFETCH_BUDGET")) {
+        try { config.max_per_second = std::stoi(v); } catch (...) {}
+    }
+    return config;
+}
+
+// Per-client rate limiting: FLIGHT_RATE_LIMIT tokens per second (unset or 0
+// = off), FLIGHT_RATE_BURST bucket size, FLIGHT_RATE_SEARCH_COST per search
+static RateLimitConfig rate_limit_config() {
+    RateLimitConfig config;
+    try {
+        if (const char* v = std::getenv("FLIGHT_RATE_LIMIT")) config.tokens_per_second = std::stoi(v);
+        if (const char* v = std::getenv("FLIGHT_RATE_BURST")) config.burst = std::stoi(v);
+        if (const char* v = std::getenv("FLIGHT_RATE_SEARCH_COST")) config.search_cost = std::stoi(v);
+    } catch (...) {
+        std::cerr << "Invalid FLIGHT_RATE_* value" << std::endl;
+    }
+    return config;
+}
+
+// Background maintenance: FLIGHT_MAINTENANCE_LOAD foreground searches in
+// flight hold tasks back (default 1, i.e. run only when idle),
+// FLIGHT_MAINTENANCE_CPU caps its share of one core (default 0.25)
+static MaintenanceConfig maintenance_config() {
+    MaintenanceConfig config;
+    try {
+        if (const char* v = std::getenv("FLIGHT_MAINTENANCE_LOAD")) config.load_threshold = std::stoi(v);
+        if (const char* v = std::getenv("FLIGHT_MAINTENANCE_CPU")) config.cpu_share = std::stod(v);
+    } catch (...) {
+        std::cerr << "Invalid FLIGHT_MAINTENANCE_* value" << std::endl;
+    }
+    return config;
+}
+
+// Tripped on SIGINT / SIGTERM so searches still running let go of the DB
+// lock at once instead of holding up shutdown
+CancelToken server_cancel;
+static volatile std::sig_atomic_t shutdown_requested = 0;
+static void on_shutdown_signal(int) { shutdown_requested = 1; }
+
+static const std::string DB_FILE = "flight_database.json";
+static const std::string POPULAR_SEARCHES_FILE = DB_FILE + ".popular";
+static const std::string LOCAL_PEER = "unix"; // remote_ip_address of Unix socket requests
+
+JsonDB db(DB_FILE);
+HoldManager holds(db.seats());
+ResponseCache search_cache;
+SearchPrefetcher prefetcher(db, search_cache, prefetch_config());
+StandingQueries standing(db);
+StatusIngest status_feed(db);
+MetricsRegistry metrics;
+const RateLimitConfig rate_limit = rate_limit_config();
+RateLimiter rate_limiter(rate_limit);
+PopularQueries popular_searches;
+MaintenanceScheduler maintenance([] { return prefetcher.foreground_searches(); }, maintenance_config());
+
+// ==========================================
+// RATE LIMIT MIDDLEWARE
+// ==========================================
+// Clients are identified by their address: nothing validates X-API-Key,
+// so keying on it would hand out a fresh bucket per invented key.
+// Searches cost rate_limit.search_cost tokens, other routes 1; health
+// checks and preflight requests are free. Rejects get 429 + Retry-After.
+// Each /ws/search message is a search and is charged through admit() too.
+struct RateLimitHandler {
+    struct context {};
+
+    static int cost(const crow::request& req) {
+        if (req.method == crow::HTTPMethod::OPTIONS || req.url == "/health") return 0;
+        if (req.url == "/api/search" || req.url == "/api/standing") return rate_limit.search_cost;
+        return 1;
+    }
+
+    // Takes `cost` tokens from the address's bucket; counts rejections
+    static bool admit(const std::string& address, int cost, uint64_t& retry_after_ms) {
+        if (!rate_limiter.enabled() || rate_limiter.allow("ip:" + address, cost, retry_after_ms)) return true;
+        static std::atomic<uint64_t>& rejected = metrics.counter("rate_limited");
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void before_handle(crow::request& req, crow::response& res, context&) {
+        uint64_t retry_after_ms;
+        if (admit(req.remote_ip_address, cost(req), retry_after_ms)) return;
+        res.code = 429;
+        res.add_header("Retry-After", std::to_string((retry_after_ms + 999) / 1000));
+        res.body = "{\"error\": \"Too many requests\"}";
+        res.end();
+    }
+
+    void after_handle(crow::request&, crow::response&, context&) {}
+};
+
+// Reads the /api/search parameters into a resolved SearchRequest. Returns
+// 0, or the HTTP status to answer with (and `error` as the body).
+static int parse_search(const crow::request& req, SearchRequest& r, std::string& error) {
+    return parse_search_params(db, [&](const std::string& name) { return req.url_params.get(name); }, r, error);
+}
+
+// A flight listed twice in one booking would take its seats twice
+static bool has_duplicate_flights(std::vector<std::string> ids) {
+    std::sort(ids.begin(), ids.end());
+    return std::adjacent_find(ids.begin(), ids.end()) != ids.end();
+}
+
+// ==========================================
+// MAINTENANCE TASKS
+// ==========================================
+
+// Re-runs the most popular searches while the server is idle. The response
+// cache keeps them for its TTL only, but the continuation profiles built on
+// the way stay until the data changes.
+static void warm_search_cache(const MaintenanceRun& run) {
+    for (const auto& query : popular_searches.top(64)) {
+        if (run.should_stop()) break;
+        QueryParams params(query);
+        SearchRequest r;
+        std::string error;
+        if (parse_search_params(db, params.lookup(), r, error)) continue;
+        std::string key = r.key();
+        uint64_t version = db.version(r.date);
+        if (search_cache.contains(key, version)) continue;
+
+        SearchStats stats;
+        std::string body = run_search(db, r, &stats, nullptr, &run.token()).dump();
+        if (!stats.cancelled) search_cache.put(key, version, body, true);
+    }
+}
+
+static void schedule_maintenance() {
+    using std::chrono::minutes;
+    using std::chrono::seconds;
+    const size_t JOURNAL_FOLD_EVENTS = 20000;
+
+    // A full save, so only once the status or bookings journal is long
+    maintenance.add({"status_journal_fold", 0, seconds(60), seconds(0), [=](const MaintenanceRun&) {
+        if (db.journal_size() + db.booking_journal_size() >= JOURNAL_FOLD_EVENTS) db.fold_journal();
+    }});
+    // Once superseded frames are over half the file
+    maintenance.add({"price_history_compact", 1, minutes(10), seconds(0), [](const MaintenanceRun&) {
+        auto st = db.prices().stats();
+        if (st.file_bytes > 2 * st.live_bytes + (1u << 20)) db.prices().compact();
+    }});
+    maintenance.add({"analytics_snapshot", 2, seconds(30), seconds(0), [](const MaintenanceRun&) {
+        db.prepare_analytics();
+    }});
+    maintenance.add({"cache_warmup", 3, minutes(1), seconds(2), warm_search_cache}, true);
+    maintenance.add({"popular_searches_save", 4, minutes(1), seconds(0), [](const MaintenanceRun&) {
+        popular_searches.save(POPULAR_SEARCHES_FILE, 64);
+    }});
+}
+
+// ==========================================
+// ASYNC REQUESTS
+// ==========================================
+// /api/search and the admin writes run as coroutines (async_task.h) that
+// answer their crow::response when done, so an I/O thread only hands the
+// request over and goes back to its sockets. Searches continue on
+// search_pool and writes (with their save()) on the persistence thread;
+// around run_search() and the write they queue on store_lock, so the
+// rest wait without holding a thread. The WebSocket, binary,
+// standing-query, prefetch and maintenance searches bypass store_lock and
+// can still block a thread on db_mutex, pool threads included.
+// FLIGHT_SEARCH_THREADS sizes the pool, FLIGHT_IO_THREADS Crow's.
+
+static unsigned env_threads(const char* name, unsigned fallback) {
+    if (const char* v = std::getenv(name)) {
+        try { return (unsigned)std::max(1, std::stoi(v)); } catch (...) {}
+    }
+    return fallback;
+}
+
+Executor search_pool("search", env_threads("FLIGHT_SEARCH_THREADS", std::max(1u, std::thread::hardware_concurrency())));
+Executor persistence("persistence", 1); // One writer keeps saves in arrival order
+AsyncMutex store_lock;                  // Held around run_search() and the admin writes
+
+// Async responses finish on pool threads. handle_local registers its
+// response here and waits on its own condition variable, so completing
+// one wakes only the thread that is waiting for it.
+static std::mutex completion_mutex;
+static std::unordered_map<const crow::response*, std::condition_variable*> completion_waiters;
+
+static void complete(crow::response& res, crow::response&& out) {
+    std::lock_guard<std::mutex> lock(completion_mutex);
+    res = std::move(out);
+    res.end();
+    auto it = completion_waiters.find(&res);
+    if (it != completion_waiters.end()) it->second->notify_one();
+}
+
+// `query` is the raw query string. A search stops when its client hangs up
+// (res.is_alive(), probed from the search loop; `watch_client` is false
+// for Unix socket requests, which have no connection behind `res`), at
+// timeout_ms (counted from arrival, queueing included) and at shutdown.
+static AsyncTask search_async(std::string query, crow::response& res, bool watch_client) {
+    SearchPrefetcher::Foreground busy(prefetcher);
+    auto start = std::chrono::steady_clock::now();
+    CancelToken cancel(&server_cancel);
+    if (watch_client) cancel.set_probe([&res] { return res.is_alive(); });
+    co_await search_pool.schedule();
+
+    crow::response out;
+    try {
+        QueryParams params(query);
+        SearchRequest r;
+        std::string error;
+        if (int status = parse_search_params(db, params.lookup(), r, error)) {
+            complete(res, crow::response(status, error));
+            co_return;
+        }
+        if (r.timeout_ms > 0) {
+            auto queued = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            cancel.set_timeout(std::chrono::milliseconds(r.timeout_ms) - queued);
+        }
+        std::string key = r.key();
+        if (!query.empty()) popular_searches.record(key, query);
+        uint64_t version = db.version(r.date);
+
+        ResponseCache::Hit hit;
+        if (search_cache.get(key, version, hit)) {
+            out = crow::response(hit.body);
+            out.add_header("X-Cache", hit.prefetched ? "PREFETCHED" : "HIT");
+            prefetcher.after_search(r);
+            complete(res, std::move(out));
+            co_return;
+        }
+
+        // A write landing after db.version(date) only makes this entry fresher
+        // than its key; the next lookup misses on the newer version anyway
+        SearchStats stats;
+        json routes;
+        {
+            auto guard = co_await store_lock.lock(search_pool);
+            routes = run_search(db, r, &stats, nullptr, &cancel);
+        }
+        std::string body = routes.dump();
+        if (stats.cancelled) {
+            metrics.counter("search_cancelled").fetch_add(1);
+            out = crow::response(body);
+            out.add_header("X-Search-Cancelled", "1"); // Partial: the routes found before the deadline
+        } else {
+            search_cache.put(key, version, body, false);
+            prefetcher.after_search(r);
+            metrics.histogram("search_miss_ms").record_ms(
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            out = crow::response(body);
+            out.add_header("X-Cache", "MISS");
+            out.add_header("X-Search-Labels-Pushed", std::to_string(stats.pushed));
+            out.add_header("X-Search-Labels-Popped", std::to_string(stats.popped));
+            out.add_header("X-Search-Memo-Hits", std::to_string(stats.memo_hits));
+        }
+    } catch (...) {
+        out = crow::response(500);
+    }
+    complete(res, std::move(out));
+}
+
+// Runs an admin write on the persistence thread; answers once it is saved
+static AsyncTask write_async(crow::response& res, std::function<crow::response()> op) {
+    co_await persistence.schedule();
+    crow::response out;
+    try {
+        auto guard = co_await store_lock.lock(persistence);
+        out = op();
+    } catch (...) {
+        out = crow::response(500);
+    }
+    complete(res, std::move(out));
+}
+
+static json executor_json(Executor& pool) {
+    Executor::Stats s = pool.stats();
+    return {{"threads", s.threads}, {"queued", s.queued}, {"max_queued", s.max_queued}, {"resumed", s.resumed}};
+}
+
+// ==========================================
+// STREAMED SEARCHES
+// ==========================================
+// A /ws/search query runs on its own thread rather than the connection's
+// I/O thread, so that a close (or a newer query on the same socket) can
+// cancel it while it runs.
+
+struct StreamSearch {
+    CancelToken cancel{&server_cancel};
+    std::thread worker;
+};
+
+static std::mutex stream_mutex;
+static std::unordered_map<crow::websocket::connection*, std::unique_ptr<StreamSearch>> streams;
+
+// Pushes each route as {"route", "index", "elapsed_ms"} the moment the
+// engine settles it, then {"done": true, "count", "first_result_ms", ...}
+static void stream_search(crow::websocket::connection& conn, const SearchRequest& r, const CancelToken& cancel) {
+    SearchPrefetcher::Foreground busy(prefetcher);
+    uint64_t version = db.version(r.date);
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_ms = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    int sent = 0;
+    double first_ms = -1;
+    SearchStats stats;
+    json routes = run_search(db, r, &stats, [&](const json& route) {
+        double ms = elapsed_ms();
+        if (sent == 0) first_ms = ms;
+        conn.send_text(json{{"route", route}, {"index", sent++}, {"elapsed_ms", ms}}.dump());
+    }, &cancel);
+    double total_ms = elapsed_ms();
+
+    if (stats.cancelled) {
+        metrics.counter("search_cancelled").fetch_add(1);
+    } else {
+        if (first_ms >= 0) metrics.histogram("stream_first_result_ms").record_ms(first_ms);
+        metrics.histogram("stream_total_ms").record_ms(total_ms);
+        search_cache.put(r.key(), version, routes.dump(), false);
+    }
+    conn.send_text(json{{"done", true}, {"count", sent}, {"cancelled", stats.cancelled},
+                        {"first_result_ms", first_ms >= 0 ? json(first_ms) : json()}, {"elapsed_ms", total_ms}}.dump());
+}
+
+// Cancels the connection's running search, if any, and waits for it
+static void stop_stream(crow::websocket::connection* conn) {
+    std::unique_ptr<StreamSearch> stream;
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        auto it = streams.find(conn);
+        if (it == streams.end()) return;
+        stream = std::move(it->second);
+        streams.erase(it);
+    }
+    stream->cancel.cancel();
+    stream->worker.join();
+}
+
+#ifndef _WIN32
+// ==========================================
+// UNIX SOCKET LISTENER
+// ==========================================
+
+static bool parse_method(const std::string& name, crow::HTTPMethod& method) {
+    static const std::unordered_map<std::string, crow::HTTPMethod> methods = {
+        {"GET", crow::HTTPMethod::GET}, {"POST", crow::HTTPMethod::POST}, {"PUT", crow::HTTPMethod::PUT},
+        {"DELETE", crow::HTTPMethod::DELETE}, {"OPTIONS", crow::HTTPMethod::OPTIONS},
+        {"HEAD", crow::HTTPMethod::HEAD}, {"PATCH", crow::HTTPMethod::PATCH}
+    };
+    auto it = methods.find(name);
+    if (it == methods.end()) return false;
+    method = it->second;
+    return true;
+}
+
+// Routes a request from the Unix socket through the app's router.
+// handle_full() runs no middleware, so CORS and rate limiting are both
+// skipped: local callers are not browsers, only processes on this host
+// with write access to the socket file can connect, and they would all
+// share one LOCAL_PEER bucket anyway.
+template <typename App>
+static void handle_local(App& app, const LocalRequest& in, LocalResponse& out) {
+    crow::request req;
+    if (!parse_method(in.method, req.method)) {
+        out.code = 501;
+        out.body = "Unsupported method";
+        return;
+    }
+    req.raw_url = in.target;
+    req.url = in.target.substr(0, in.target.find('?'));
+    req.url_params = crow::query_string(in.target);
+    for (const auto& h : in.headers) req.headers.emplace(h.first, h.second);
+    req.body = in.body;
+    req.remote_ip_address = LOCAL_PEER;
+
+    crow::response res;
+    std::condition_variable done;
+    {
+        std::lock_guard<std::mutex> lock(completion_mutex);
+        completion_waiters[&res] = &done;
+    }
+    app.handle_full(req, res);
+    {
+        std::unique_lock<std::mutex> lock(completion_mutex); // Async routes finish on another thread
+        done.wait(lock, [&res] { return res.is_completed(); });
+        completion_waiters.erase(&res);
+    }
+    out.code = res.code;
+    out.body = std::move(res.body);
+    for (const auto& h : res.headers) out.headers.push_back({h.first, h.second});
+}
+#endif
 
 int main() {
-    crow::App<CORSHandler> app;
+    crow::App<CORSHandler, RateLimitHandler> app;
 
     // ==========================================
     // 1. PUBLIC ROUTES
@@ -44,15 +463,34 @@ int main() {
             {"endpoints", {
                 {"/health", "Health check"},
                 {"/api/airports", "Get all airports"},
-                {"/api/flights", "Get flights (limit parameter)"},
-                {"/api/search", "Search flights (from, to, date parameters)"}
+                {"/api/airports/suggest", "Autocomplete airports by code, city or name (q, limit)"},
+                {"/api/airports/near", "Airports near a point (lat, lng; radius_km or limit)"},
+                {"/api/flights", "Get flights (origin, destination, date, airline, min_price, max_price, sort=price|departure, order, limit, offset)"},
+                {"/api/flights/{id}/history", "Fare changes of a flight (from, to in unix seconds; limit)"},
+                {"/api/search", "Search flights (from/from_city/from_radius_km, to/to_city/to_radius_km, date; optional airline, max_price, max_stops, avoid, via, mode=exact|fast, beam, seats, timeout_ms)"},
+                {"/api/seats", "Seats left (flights=ID,ID)"},
+                {"/api/standing", "POST - Register a standing search (same parameters as /api/search)"},
+                {"/api/standing/get", "Current result of a standing search (id)"},
+                {"/api/standing/remove", "POST - Remove a standing search (id)"},
+                {"/ws/standing", "WebSocket - send {\"subscribe\": id} to receive result changes"},
+                {"/ws/search", "WebSocket - send /api/search parameters as a query string; routes arrive as they are found"},
+                {"/api/analytics", "Fare aggregates (group_by=route|origin|destination|airline|date, filters)"},
+                {"/api/book", "POST - Book seats on every flight of an itinerary"},
+                {"/api/hold", "POST - Hold seats for ttl_seconds"},
+                {"/api/hold/confirm", "POST - Confirm a hold"},
+                {"/api/hold/release", "POST - Release a hold"}
             }},
             {"admin", {
                 {"/admin/airport/add", "POST - Add airport"},
                 {"/admin/airport/delete", "POST - Delete airport"},
                 {"/admin/flight/add", "POST - Add flight"},
                 {"/admin/flight/delete", "POST - Delete flight"},
-                {"/admin/flight/update", "POST - Update flight"}
+                {"/admin/flight/update", "POST - Update flight"},
+                {"/admin/flight/status", "POST - NDJSON status feed ({\"id\", \"delay_minutes\"} or {\"id\", \"status\": cancelled|scheduled|on_time})"},
+                {"/admin/maintenance", "Background task queue with timings"},
+                {"/admin/maintenance/run", "POST - Run a maintenance task as soon as the server is idle (task)"},
+                {"/admin/search/cache", "Response cache and speculative prefetch counters"},
+                {"/admin/metrics", "Latency histograms (p50/p90/p99), counters, rate limiter, status feed and price history state"}
             }}
         };
         return crow::response(response.dump());
@@ -69,23 +507,304 @@ int main() {
         return crow::response(db.get_all_airports().dump());
     });
 
+    // Autocomplete: airports whose code, city or name starts with q
+    CROW_ROUTE(app, "/api/airports/suggest")
+    ([](const crow::request& req){
+        const char* q = req.url_params.get("q");
+        if (!q) return crow::response(400, "Missing q");
+        int limit = 8;
+        try {
+            if (req.url_params.get("limit")) limit = std::stoi(req.url_params.get("limit"));
+        } catch (...) { return crow::response(400, "Invalid limit"); }
+        return crow::response(db.suggest_airports(q, limit).dump());
+    });
+
+    // Airports within radius_km of a point, or the nearest `limit` without a radius
+    CROW_ROUTE(app, "/api/airports/near")
+    ([](const crow::request& req){
+        if (!req.url_params.get("lat") || !req.url_params.get("lng")) return crow::response(400, "Missing lat/lng");
+        try {
+            double lat = std::stod(req.url_params.get("lat"));
+            double lng = std::stod(req.url_params.get("lng"));
+            double radius = req.url_params.get("radius_km") ? std::stod(req.url_params.get("radius_km")) : 0;
+            int limit = req.url_params.get("limit") ? std::stoi(req.url_params.get("limit")) : 5;
+            return crow::response(db.airports_near(lat, lng, radius, limit).dump());
+        } catch (...) { return crow::response(400, "Invalid parameters"); }
+    });
+
+    // Flight listing: optional origin, destination, date, airline and
+    // min_price/max_price filters, sort=price|departure, order=asc|desc
     CROW_ROUTE(app, "/api/flights")
     ([](const crow::request& req){
-        int limit = 10;
-        if (req.url_params.get("limit")) limit = std::stoi(req.url_params.get("limit"));
-        return crow::response(db.get_flights_limited(limit).dump());
+        FlightQuery q;
+        if (const char* v = req.url_params.get("origin")) q.origin = v;
+        if (const char* v = req.url_params.get("destination")) q.destination = v;
+        if (const char* v = req.url_params.get("date")) q.date = v;
+        if (const char* v = req.url_params.get("airline")) q.airline = v;
+        try {
+            if (req.url_params.get("limit")) q.limit = std::stoi(req.url_params.get("limit"));
+            if (req.url_params.get("offset")) q.offset = std::stoi(req.url_params.get("offset"));
+            if (req.url_params.get("min_price")) q.min_price = std::stoi(req.url_params.get("min_price"));
+            if (req.url_params.get("max_price")) q.max_price = std::stoi(req.url_params.get("max_price"));
+        } catch (...) { return crow::response(400, "Invalid parameters"); }
+
+        if (const char* v = req.url_params.get("sort")) {
+            std::string sort = v;
+            if (sort == "price") q.sort = FlightQuery::PRICE;
+            else if (sort == "departure") q.sort = FlightQuery::DEPARTURE;
+            else return crow::response(400, "Invalid sort");
+        }
+        if (const char* v = req.url_params.get("order")) q.descending = std::string(v) == "desc";
+
+        std::string plan;
+        crow::response res(db.find_flights(q, &plan).dump());
+        res.add_header("X-Query-Plan", plan);
+        return res;
+    });
+
+    // Fare history of one flight (from / to in unix seconds, newest `limit`)
+    CROW_ROUTE(app, "/api/flights/<string>/history")
+    ([](const crow::request& req, std::string id){
+        int64_t from = 0, to = INT64_MAX;
+        size_t limit = 1000;
+        try {
+            if (const char* v = req.url_params.get("from")) from = std::stoll(v);
+            if (const char* v = req.url_params.get("to")) to = std::stoll(v);
+            if (const char* v = req.url_params.get("limit")) limit = (size_t)std::max(1, std::stoi(v));
+        } catch (...) { return crow::response(400, "Invalid parameters"); }
+
+        json history = db.price_history(id, from, to, limit);
+        if (history.is_null()) return crow::response(404, "Not Found");
+        return crow::response(history.dump());
     });
 
     CROW_ROUTE(app, "/api/search")
+    ([](const crow::request& req, crow::response& res){
+        size_t query_at = req.raw_url.find('?');
+        search_async(query_at == std::string::npos ? "" : req.raw_url.substr(query_at + 1), res,
+                     req.remote_ip_address != LOCAL_PEER);
+    });
+
+    // Progressive search: send the /api/search parameters as a query string
+    // ("from=DEL&to=BOM&date=2024-05-01") and routes arrive cheapest first
+    // as they are found (see stream_search). Closing the socket or sending
+    // a new query cancels the search in flight.
+    CROW_WEBSOCKET_ROUTE(app, "/ws/search")
+    .onclose([](crow::websocket::connection& conn, const std::string&, auto...){
+        stop_stream(&conn);
+    })
+    .onmessage([](crow::websocket::connection& conn, const std::string& data, bool){
+        uint64_t retry_after_ms;
+        if (!RateLimitHandler::admit(conn.get_remote_ip(), rate_limit.search_cost, retry_after_ms)) {
+            conn.send_text(json{{"error", "Too many requests"}, {"retry_after_ms", retry_after_ms}}.dump());
+            return;
+        }
+        crow::request req;
+        req.url_params = crow::query_string("?" + (data.size() && data[0] == '?' ? data.substr(1) : data));
+        SearchRequest r;
+        std::string error;
+        if (parse_search(req, r, error)) {
+            conn.send_text(json{{"error", error}}.dump());
+            return;
+        }
+
+        stop_stream(&conn);
+        std::unique_ptr<StreamSearch> stream(new StreamSearch());
+        if (r.timeout_ms > 0) stream->cancel.set_timeout(std::chrono::milliseconds(r.timeout_ms));
+        crow::websocket::connection* target = &conn;
+        const CancelToken* cancel = &stream->cancel;
+        stream->worker = std::thread([target, r, cancel] { stream_search(*target, r, *cancel); });
+
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        streams[&conn] = std::move(stream);
+    });
+
+    // ==========================================
+    // STANDING QUERIES
+    // ==========================================
+    // Register a search once (same parameters as /api/search), then follow
+    // it over /ws/standing instead of polling: send {"subscribe": "<id>"}
+    // and a message arrives whenever its top K changes.
+
+    CROW_ROUTE(app, "/api/standing").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        SearchRequest r;
+        std::string error;
+        if (int status = parse_search(req, r, error)) return crow::response(status, error);
+
+        json routes;
+        std::string id = standing.add(r, &routes);
+        if (id.empty()) return crow::response(503, "Too many standing queries");
+        return crow::response(201, json{{"id", id}, {"routes", routes}}.dump());
+    });
+
+    CROW_ROUTE(app, "/api/standing/get")
     ([](const crow::request& req){
-        const char* src = req.url_params.get("from");
-        const char* dst = req.url_params.get("to");
-        std::string date = "2025-12-01";
-        if (req.url_params.get("date")) date = req.url_params.get("date");
+        const char* id = req.url_params.get("id");
+        if (!id) return crow::response(400, "Missing id");
+        json routes;
+        if (!standing.current(id, routes)) return crow::response(404, "Unknown standing query");
+        return crow::response(json{{"id", id}, {"routes", routes}}.dump());
+    });
 
-        if (!src || !dst) return crow::response(400, "Missing parameters");
-        
-        return crow::response(db.find_smart_routes(src, dst, date, 5).dump());
+    CROW_ROUTE(app, "/api/standing/remove").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+        const char* id = req.url_params.get("id");
+        if (!id) return crow::response(400, "Missing id");
+        if (!standing.remove(id)) return crow::response(404, "Unknown standing query");
+        return crow::response(200, "Removed");
+    });
+
+    // Per connection: the subscriptions to drop when it closes
+    static std::mutex ws_mutex;
+    static std::unordered_map<crow::websocket::connection*, std::vector<StandingQueries::SubscriberId>> ws_subs;
+
+    CROW_WEBSOCKET_ROUTE(app, "/ws/standing")
+    .onopen([](crow::websocket::connection& conn){
+        std::lock_guard<std::mutex> lock(ws_mutex);
+        ws_subs[&conn];
+    })
+    .onclose([](crow::websocket::connection& conn, const std::string&, auto...){
+        std::vector<StandingQueries::SubscriberId> subs;
+        {
+            std::lock_guard<std::mutex> lock(ws_mutex);
+            subs = std::move(ws_subs[&conn]);
+            ws_subs.erase(&conn);
+        }
+        for (auto sub : subs) standing.unsubscribe(sub);
+    })
+    .onmessage([](crow::websocket::connection& conn, const std::string& data, bool){
+        auto msg = json::parse(data, nullptr, false);
+        if (msg.is_discarded() || !msg.contains("subscribe") || !msg["subscribe"].is_string()) {
+            conn.send_text(json{{"error", "Expected {\"subscribe\": \"<id>\"}"}}.dump());
+            return;
+        }
+        std::string id = msg["subscribe"];
+        crow::websocket::connection* target = &conn;
+        auto sub = standing.subscribe(id, [target](const std::string& update) { target->send_text(update); });
+        json routes;
+        if (!sub || !standing.current(id, routes)) {
+            conn.send_text(json{{"error", "Unknown standing query"}, {"query", id}}.dump());
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(ws_mutex);
+            ws_subs[&conn].push_back(sub);
+        }
+        conn.send_text(json{{"query", id}, {"routes", routes}}.dump());
+    });
+
+    // Fare analytics: group_by=route,origin,destination,airline,date plus
+    // origin, destination, airline, date_from, date_to, min_price, max_price filters
+    CROW_ROUTE(app, "/api/analytics")
+    ([](const crow::request& req){
+        AnalyticsQuery q;
+        if (!parse_group_keys(req.url_params.get("group_by") ? req.url_params.get("group_by") : "route", q.group_by)) {
+            return crow::response(400, "Invalid group_by");
+        }
+        if (req.url_params.get("origin")) q.origin = req.url_params.get("origin");
+        if (req.url_params.get("destination")) q.destination = req.url_params.get("destination");
+        if (req.url_params.get("airline")) q.airline = req.url_params.get("airline");
+        if (req.url_params.get("date_from")) q.date_from = req.url_params.get("date_from");
+        if (req.url_params.get("date_to")) q.date_to = req.url_params.get("date_to");
+        try {
+            if (req.url_params.get("min_price")) q.min_price = std::stoi(req.url_params.get("min_price"));
+            if (req.url_params.get("max_price")) q.max_price = std::stoi(req.url_params.get("max_price"));
+        } catch (...) { return crow::response(400, "Invalid parameters"); }
+
+        json out = db.analytics(q);
+        if (out.contains("error")) return crow::response(400, out.dump());
+        return crow::response(out.dump());
+    });
+
+    // Seats left on the given flights
+    CROW_ROUTE(app, "/api/seats")
+    ([](const crow::request& req){
+        std::vector<std::string> ids = split_csv(req.url_params.get("flights"));
+        if (ids.empty()) return crow::response(400, "Missing flights");
+        return crow::response(db.seat_availability(ids).dump());
+    });
+
+    // BOOK: {"flights": ["FL1001", "FL2040"], "seats": 2}, all legs or nothing
+    CROW_ROUTE(app, "/api/book").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        auto body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded()) return crow::response(400, "Invalid JSON");
+        std::vector<std::string> ids;
+        int seats = 1;
+        try {
+            ids = body.at("flights").get<std::vector<std::string>>();
+            seats = body.value("seats", 1);
+        } catch (...) { return crow::response(400, "Bad Request"); }
+        if (ids.empty() || seats < 1) return crow::response(400, "Bad Request");
+        if (has_duplicate_flights(ids)) return crow::response(400, "Duplicate flight");
+
+        std::string failed;
+        switch (db.book_seats(ids, seats, &failed)) {
+            case SeatInventory::Result::OK:
+                return crow::response(200, json{{"status", "booked"}, {"flights", ids}, {"seats", seats}}.dump());
+            case SeatInventory::Result::UNKNOWN_FLIGHT:
+                return crow::response(404, json{{"error", "Unknown flight"}, {"flight", failed}}.dump());
+            default:
+                return crow::response(409, json{{"error", "Sold out"}, {"flight", failed}}.dump());
+        }
+    });
+
+    // HOLD: {"flights": [...], "seats": 1, "ttl_seconds": 300}; seats return on expiry
+    CROW_ROUTE(app, "/api/hold").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        auto body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded()) return crow::response(400, "Invalid JSON");
+        std::vector<std::string> ids;
+        int seats = 1, ttl = 300;
+        try {
+            ids = body.at("flights").get<std::vector<std::string>>();
+            seats = body.value("seats", 1);
+            ttl = body.value("ttl_seconds", 300);
+        } catch (...) { return crow::response(400, "Bad Request"); }
+        if (ids.empty() || seats < 1 || ttl < 1 || ttl > 3600) return crow::response(400, "Bad Request");
+        if (has_duplicate_flights(ids)) return crow::response(400, "Duplicate flight");
+
+        HoldManager::PlaceResult r = holds.place(ids, seats, ttl);
+        switch (r.status) {
+            case SeatInventory::Result::OK:
+                return crow::response(201, json{{"hold_id", r.hold_id}, {"expires_in_seconds", ttl}}.dump());
+            case SeatInventory::Result::UNKNOWN_FLIGHT:
+                return crow::response(404, json{{"error", "Unknown flight"}, {"flight", r.failed_flight}}.dump());
+            default:
+                return crow::response(409, json{{"error", "Sold out"}, {"flight", r.failed_flight}}.dump());
+        }
+    });
+
+    // CONFIRM / RELEASE HOLD: {"hold_id": "..."}; 404 once it has expired
+    CROW_ROUTE(app, "/api/hold/confirm").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        auto body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded()) return crow::response(400, "Invalid JSON");
+        std::string id = body.value("hold_id", "");
+        if (db.commit_hold([&](std::vector<std::string>& flights, int& seats) { return holds.confirm(id, &flights, &seats); })) {
+            return crow::response(200, "Confirmed");
+        }
+        return crow::response(404, "Not Found");
+    });
+
+    CROW_ROUTE(app, "/api/hold/release").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        auto body = json::parse(req.body, nullptr, false);
+        if (body.is_discarded()) return crow::response(400, "Invalid JSON");
+        if (holds.release(body.value("hold_id", ""))) return crow::response(200, "Released");
+        return crow::response(404, "Not Found");
     });
 
     // ==========================================
@@ -95,67 +814,157 @@ int main() {
 
     // ADD AIRPORT
     CROW_ROUTE(app, "/admin/airport/add").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
-    ([](const crow::request& req){
-        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200); // Handle Preflight
-        
-        auto body = json::parse(req.body, nullptr, false);
-        if (body.is_discarded()) return crow::response(400);
-        try {
-            if (db.add_airport(body.get<Airport>())) return crow::response(201, "Added");
-            return crow::response(409, "Exists");
-        } catch(...) { return crow::response(400); }
+    ([](const crow::request& req, crow::response& res){
+        if (req.method == crow::HTTPMethod::OPTIONS) return complete(res, crow::response(200)); // Handle Preflight
+
+        write_async(res, [text = req.body]() {
+            auto body = json::parse(text, nullptr, false);
+            if (body.is_discarded()) return crow::response(400);
+            try {
+                if (db.add_airport(body.get<Airport>())) return crow::response(201, "Added");
+                return crow::response(409, "Exists");
+            } catch(...) { return crow::response(400); }
+        });
     });
 
     // DELETE AIRPORT
     CROW_ROUTE(app, "/admin/airport/delete").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
-    ([](const crow::request& req){
-        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+    ([](const crow::request& req, crow::response& res){
+        if (req.method == crow::HTTPMethod::OPTIONS) return complete(res, crow::response(200));
 
         auto body = json::parse(req.body, nullptr, false);
-        if (body.is_discarded()) return crow::response(400);
-        std::string code = body.value("code", "");
-        if (db.delete_airport(code)) return crow::response(200, "Deleted");
-        return crow::response(404, "Not Found");
+        if (body.is_discarded()) return complete(res, crow::response(400));
+        write_async(res, [code = body.value("code", "")]() {
+            if (db.delete_airport(code)) return crow::response(200, "Deleted");
+            return crow::response(404, "Not Found");
+        });
     });
 
     // ADD FLIGHT
     CROW_ROUTE(app, "/admin/flight/add").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
-    ([](const crow::request& req){
-        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200); // Handle Preflight
+    ([](const crow::request& req, crow::response& res){
+        if (req.method == crow::HTTPMethod::OPTIONS) return complete(res, crow::response(200)); // Handle Preflight
 
         auto body = json::parse(req.body, nullptr, false);
-        if (body.is_discarded()) return crow::response(400, "Invalid JSON");
+        if (body.is_discarded()) return complete(res, crow::response(400, "Invalid JSON"));
 
-        try {
-            Flight fl = body.get<Flight>();
-            if (db.add_flight(fl)) return crow::response(201, "Added");
-            return crow::response(409, "Exists");
-        } catch (...) { return crow::response(400, "Bad Request"); }
+        Flight fl;
+        try { fl = body.get<Flight>(); } catch (...) { return complete(res, crow::response(400, "Bad Request")); }
+        write_async(res, [fl]() {
+            switch (db.add_flight(fl)) {
+                case JsonDB::AddFlightResult::ADDED: return crow::response(201, "Added");
+                case JsonDB::AddFlightResult::DUPLICATE: return crow::response(409, "Exists");
+                default: return crow::response(422, "Unknown airport");
+            }
+        });
     });
 
     // DELETE FLIGHT
     CROW_ROUTE(app, "/admin/flight/delete").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
-    ([](const crow::request& req){
-        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+    ([](const crow::request& req, crow::response& res){
+        if (req.method == crow::HTTPMethod::OPTIONS) return complete(res, crow::response(200));
 
         auto body = json::parse(req.body, nullptr, false);
-        if (body.is_discarded()) return crow::response(400);
-        std::string id = body.value("id", "");
-        if (db.delete_flight(id)) return crow::response(200, "Deleted");
-        return crow::response(404, "Not Found");
+        if (body.is_discarded()) return complete(res, crow::response(400));
+        write_async(res, [id = body.value("id", "")]() {
+            if (db.delete_flight(id)) return crow::response(200, "Deleted");
+            return crow::response(404, "Not Found");
+        });
+    });
+
+    // Response cache and prefetcher counters
+    CROW_ROUTE(app, "/admin/search/cache")
+    ([](){
+        ResponseCache::Stats c = search_cache.stats();
+        SearchPrefetcher::Stats p = prefetcher.stats();
+        json out = {
+            {"cache", {{"entries", c.entries}, {"hits", c.hits}, {"prefetched_hits", c.prefetched_hits}, {"misses", c.misses}}},
+            {"prefetch", {{"pending", p.pending}, {"queued", p.queued}, {"run", p.run}, {"skipped", p.skipped}, {"dropped", p.dropped},
+                          {"preempted", p.preempted}}}
+        };
+        return crow::response(out.dump());
+    });
+
+    // Latency histograms and counters
+    CROW_ROUTE(app, "/admin/metrics")
+    ([](){
+        json out = metrics.to_json();
+        auto r = rate_limiter.stats();
+        out["rate_limit"] = {
+            {"enabled", rate_limiter.enabled()}, {"allowed", r.allowed}, {"rejected", r.rejected},
+            {"table_full", r.table_full}, {"clients", r.clients}, {"evicted", r.evicted}
+        };
+        auto ph = db.prices().stats();
+        out["price_history"] = {
+            {"flights", ph.flights}, {"points", ph.points}, {"blocks", ph.blocks},
+            {"resident_blocks", ph.resident_blocks}, {"memory_bytes", ph.memory_bytes},
+            {"file_bytes", ph.file_bytes}, {"cold_reads", ph.cold_reads}
+        };
+        auto f = status_feed.stats();
+        out["status_feed"] = {
+            {"events", f.events}, {"applied", f.applied}, {"rejected", f.rejected}, {"batches", f.batches},
+            {"journal", db.journal_size()}
+        };
+        auto sl = store_lock.stats();
+        out["async"] = {
+            {"search_pool", executor_json(search_pool)}, {"persistence", executor_json(persistence)},
+            {"store_lock", {{"waiting", sl.waiting}, {"max_waiting", sl.max_waiting},
+                            {"acquired", sl.acquired}, {"contended", sl.contended}}}
+        };
+        return crow::response(out.dump());
     });
 
     // UPDATE FLIGHT
     CROW_ROUTE(app, "/admin/flight/update").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
-    ([](const crow::request& req){
-        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+    ([](const crow::request& req, crow::response& res){
+        if (req.method == crow::HTTPMethod::OPTIONS) return complete(res, crow::response(200));
 
         const char* id = req.url_params.get("id");
-        if (!id) return crow::response(400, "Missing id");
+        if (!id) return complete(res, crow::response(400, "Missing id"));
         auto body = json::parse(req.body, nullptr, false);
-        if (body.is_discarded()) return crow::response(400);
-        if (db.update_flight(id, body)) return crow::response(200, "Updated");
-        return crow::response(404, "Not Found");
+        if (body.is_discarded()) return complete(res, crow::response(400));
+        write_async(res, [id = std::string(id), body]() {
+            switch (db.update_flight(id, body)) {
+                case JsonDB::UpdateFlightResult::UPDATED: return crow::response(200, "Updated");
+                case JsonDB::UpdateFlightResult::NOT_FOUND: return crow::response(404, "Not Found");
+                default: return crow::response(400, "Bad Request");
+            }
+        });
+    });
+
+    // FLIGHT STATUS FEED: NDJSON delay / cancellation events (status_ingest.h),
+    // applied in place without a full save; also reachable over FLIGHT_UDS_PATH
+    CROW_ROUTE(app, "/admin/flight/status").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        auto start = std::chrono::steady_clock::now();
+        StatusIngest::Report report = status_feed.ingest(req.body);
+        metrics.histogram("status_ingest_ms").record_ms(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        json out = {
+            {"applied", report.applied},
+            {"rejected", report.rejected},
+            {"errors", report.errors},
+            {"journal", db.journal_size()}
+        };
+        return crow::response(report.applied || !report.rejected ? 200 : 400, out.dump());
+    });
+
+    // MAINTENANCE: task queue and timings; POST run?task=<name> makes one due now
+    CROW_ROUTE(app, "/admin/maintenance")
+    ([](){
+        return crow::response(maintenance.to_json().dump());
+    });
+
+    CROW_ROUTE(app, "/admin/maintenance/run").methods(crow::HTTPMethod::POST, crow::HTTPMethod::OPTIONS)
+    ([](const crow::request& req){
+        if (req.method == crow::HTTPMethod::OPTIONS) return crow::response(200);
+
+        const char* task = req.url_params.get("task");
+        if (!task) return crow::response(400, "Missing task");
+        if (!maintenance.trigger(task)) return crow::response(404, "Unknown task");
+        return crow::response(202, "Queued");
     });
 
     // CATCH-ALL (Backup for other OPTIONS requests)
@@ -183,6 +992,89 @@ int main() {
         }
     }
     
+    // FLIGHT_PRICE_HISTORY_MB: memory for sealed price history blocks (default 8)
+    if (const char* v = std::getenv("FLIGHT_PRICE_HISTORY_MB")) {
+        try { db.prices().set_memory_budget((size_t)std::stoul(v) << 20); } catch (...) {}
+    }
+
+    // Warm up from the searches that were popular before the restart
+    popular_searches.load(POPULAR_SEARCHES_FILE);
+    schedule_maintenance();
+
+    // Re-evaluate standing queries after every admin change
+    db.set_change_listener([](const ScheduleChange& change) { standing.on_change(change); });
+    db.set_held_seats([] { return holds.held_seats(); });
+
+    // Own SIGINT / SIGTERM instead of Crow, to cancel running searches
+    // before stopping the server
+    app.signal_clear();
+    std::signal(SIGINT, on_shutdown_signal);
+    std::signal(SIGTERM, on_shutdown_signal);
+
     std::cout << "Server starting on 0.0.0.0:" << port << std::endl;
-    app.port(port).multithreaded().run();
+    // FLIGHT_IO_THREADS: Crow's threads (default one per core). Searches and
+    // admin writes give theirs back while they wait, so a few carry many
+    // requests; the other routes still run on them start to finish.
+    unsigned io_threads = env_threads("FLIGHT_IO_THREADS", std::max(1u, std::thread::hardware_concurrency()));
+    auto server = app.port(port).concurrency(io_threads).run_async();
+
+#ifndef _WIN32
+    // FLIGHT_UDS_PATH: also serve the same routes on a Unix domain socket,
+    // so clients on this host skip the TCP stack. Started once Crow has
+    // built its router.
+    std::unique_ptr<UnixSocketServer> local_server;
+    if (const char* uds_path = std::getenv("FLIGHT_UDS_PATH")) {
+        app.wait_for_server_start();
+        local_server.reset(new UnixSocketServer(uds_path, [&app](const LocalRequest& in, LocalResponse& out) {
+            handle_local(app, in, out);
+        }));
+        std::string error;
+        if (local_server->start(error)) {
+            std::cout << "Also serving on unix:" << uds_path << std::endl;
+        } else {
+            std::cerr << "Unix socket listener disabled: " << error << std::endl;
+            local_server.reset();
+        }
+    }
+
+    // Binary protocol for internal services (binary_protocol.h):
+    // FLIGHT_BINARY_PORT (TCP) and / or FLIGHT_BINARY_UDS (Unix socket)
+    BinaryServer binary_server(db);
+    if (const char* v = std::getenv("FLIGHT_BINARY_PORT")) {
+        std::string error;
+        int binary_port = std::atoi(v);
+        if (binary_server.listen_tcp("0.0.0.0", binary_port, error)) {
+            std::cout << "Binary protocol on 0.0.0.0:" << binary_port << std::endl;
+        } else {
+            std::cerr << "Binary protocol (TCP) disabled: " << error << std::endl;
+        }
+    }
+    if (const char* v = std::getenv("FLIGHT_BINARY_UDS")) {
+        std::string error;
+        if (binary_server.listen_unix(v, error)) std::cout << "Binary protocol on unix:" << v << std::endl;
+        else std::cerr << "Binary protocol (Unix socket) disabled: " << error << std::endl;
+    }
+#endif
+
+    while (server.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        if (!shutdown_requested) continue;
+        server_cancel.cancel();
+        app.stop();
+        break;
+    }
+    server.wait();
+#ifndef _WIN32
+    if (local_server) local_server->stop();
+    binary_server.stop();
+#endif
+    // Let queued writes reach the disk; searches still queued see server_cancel
+    search_pool.shutdown();
+    persistence.shutdown();
+
+    std::vector<crow::websocket::connection*> open_streams;
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        for (const auto& s : streams) open_streams.push_back(s.first);
+    }
+    for (auto* conn : open_streams) stop_stream(conn);
 }
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "maintenance.h"
+#include <algorithm>
+#include <exception>
+
+using namespace std;
+using sched_clock = chrono::steady_clock;
+
+bool MaintenanceRun::should_stop() const {
+    if (!stopped && (budget.cancelled() || load() >= threshold)) stopped = true;
+    return stopped;
+}
+
+MaintenanceScheduler::MaintenanceScheduler(function<int()> foreground_load, MaintenanceConfig cfg)
+    : load(move(foreground_load)), config(cfg) {
+    worker = thread(&MaintenanceScheduler::run, this);
+}
+
+MaintenanceScheduler::~MaintenanceScheduler() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    shutdown.cancel();
+    wake.notify_all();
+    worker.join();
+}
+
+void MaintenanceScheduler::add(MaintenanceTask task, bool run_now) {
+    unique_ptr<Entry> e(new Entry());
+    auto now = sched_clock::now();
+    e->next_due = run_now ? now
+                : task.interval.count() > 0 ? now + task.interval
+                : sched_clock::time_point::max();
+    e->task = move(task);
+    {
+        lock_guard<mutex> lock(mtx);
+        tasks.push_back(move(e));
+    }
+    wake.notify_all();
+}
+
+bool MaintenanceScheduler::trigger(const string& name) {
+    {
+        lock_guard<mutex> lock(mtx);
+        auto it = find_if(tasks.begin(), tasks.end(), [&](const unique_ptr<Entry>& e) { return e->task.name == name; });
+        if (it == tasks.end()) return false;
+        (*it)->next_due = min((*it)->next_due, sched_clock::now());
+        if (running == it->get()) (*it)->rerun = true;
+    }
+    wake.notify_all();
+    return true;
+}
+
+// ==========================================
+// WORKER
+// ==========================================
+
+void MaintenanceScheduler::run() {
+    unique_lock<mutex> lock(mtx);
+    while (!stopping) {
+        auto now = sched_clock::now();
+        Entry* next = nullptr;
+        auto wake_at = now + chrono::hours(1);
+        for (auto& e : tasks) {
+            if (e->next_due > now) {
+                wake_at = min(wake_at, e->next_due);
+            } else if (!next || e->task.priority < next->task.priority) {
+                next = e.get();
+            }
+        }
+        if (!next) {
+            wake.wait_until(lock, wake_at);
+            continue;
+        }
+        if (now < quiet_until) {
+            wake.wait_until(lock, quiet_until);
+            continue;
+        }
+        if (load() >= config.load_threshold) {
+            if (!next->waiting) next->deferred++;
+            next->waiting = true;
+            wake.wait_for(lock, config.poll);
+            continue;
+        }
+
+        next->waiting = false;
+        running = next;
+        lock.unlock();
+
+        MaintenanceRun ctx(&shutdown, load, config.load_threshold);
+        if (next->task.budget.count() > 0) ctx.budget.set_timeout(next->task.budget);
+        string error;
+        auto start = sched_clock::now();
+        try {
+            next->task.run(ctx);
+        } catch (const exception& ex) {
+            error = ex.what();
+        } catch (...) {
+            error = "unknown exception";
+        }
+        auto end = sched_clock::now();
+        double ms = chrono::duration<double, milli>(end - start).count();
+
+        lock.lock();
+        running = nullptr;
+        next->runs++;
+        if (ctx.stopped) next->stopped_early++;
+        if (!error.empty()) {
+            next->failures++;
+            next->last_error = error;
+        }
+        next->last_ms = ms;
+        next->max_ms = max(next->max_ms, ms);
+        next->total_ms += ms;
+        next->last_end = end;
+        next->next_due = next->rerun ? end
+                       : next->task.interval.count() > 0 ? end + next->task.interval
+                       : sched_clock::time_point::max();
+        next->rerun = false;
+
+        double share = min(1.0, max(0.01, config.cpu_share));
+        quiet_until = end + chrono::duration_cast<sched_clock::duration>(
+                                chrono::duration<double, milli>(ms * (1 - share) / share));
+    }
+}
+
+// ==========================================
+// REPORTING
+// ==========================================
+
+json MaintenanceScheduler::to_json() {
+    lock_guard<mutex> lock(mtx);
+    auto now = sched_clock::now();
+    auto ms_between = [](sched_clock::time_point a, sched_clock::time_point b) {
+        return (int64_t)chrono::duration_cast<chrono::milliseconds>(b - a).count();
+    };
+
+    vector<const Entry*> order;
+    for (const auto& e : tasks) order.push_back(e.get());
+    stable_sort(order.begin(), order.end(), [](const Entry* a, const Entry* b) {
+        return a->next_due != b->next_due ? a->next_due < b->next_due : a->task.priority < b->task.priority;
+    });
+
+    json queue = json::array();
+    for (const Entry* e : order) {
+        bool scheduled = e->next_due != sched_clock::time_point::max();
+        queue.push_back({
+            {"name", e->task.name},
+            {"priority", e->task.priority},
+            {"interval_ms", (int64_t)e->task.interval.count()},
+            {"budget_ms", (int64_t)e->task.budget.count()},
+            {"due_in_ms", scheduled ? json(max<int64_t>(0, ms_between(now, e->next_due))) : json(nullptr)},
+            {"waiting_for_idle", e->waiting},
+            {"runs", e->runs},
+            {"deferred", e->deferred},
+            {"stopped_early", e->stopped_early},
+            {"failures", e->failures},
+            {"last_error", e->last_error},
+            {"last_ms", e->last_ms},
+            {"max_ms", e->max_ms},
+            {"mean_ms", e->runs ? e->total_ms / e->runs : 0.0},
+            {"last_run_ago_ms", e->runs ? json(ms_between(e->last_end, now)) : json(nullptr)}
+        });
+    }
+    return {
+        {"running", running ? json(running->task.name) : json(nullptr)},
+        {"foreground_load", load()},
+        {"load_threshold", config.load_threshold},
+        {"cpu_share", config.cpu_share},
+        {"quiet_for_ms", max<int64_t>(0, ms_between(now, quiet_until))},
+        {"queue", queue}
+    };
+}
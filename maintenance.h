@@ -0,0 +1,92 @@
+#ifndef MAINTENANCE_H
+#define MAINTENANCE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "cancel_token.h"
+
+using json = nlohmann::json;
+
+struct MaintenanceConfig {
+    int load_threshold = 1;   // Tasks start only while fewer foreground searches than this are in flight
+    double cpu_share = 0.25;  // After a run of T, wait T * (1 - share) / share before the next one
+    std::chrono::milliseconds poll{50}; // Load re-check period while a due task waits
+};
+
+// Handed to a running task. Long tasks work in small steps and return
+// once should_stop() says so; token() can be passed to searches.
+class MaintenanceRun {
+public:
+    const CancelToken& token() const { return budget; } // Trips when the budget is spent or on shutdown
+    bool should_stop() const;                            // ...or when foreground load is back
+
+private:
+    friend class MaintenanceScheduler;
+    MaintenanceRun(const CancelToken* shutdown, const std::function<int()>& load, int threshold)
+        : budget(shutdown), load(load), threshold(threshold) {}
+
+    CancelToken budget;
+    const std::function<int()>& load;
+    const int threshold;
+    mutable bool stopped = false;
+};
+
+struct MaintenanceTask {
+    std::string name;
+    int priority = 0;                    // Lower runs first when several are due
+    std::chrono::milliseconds interval;  // Between runs; 0 = only when triggered
+    std::chrono::milliseconds budget;    // Wall time a run may take before its token trips
+    std::function<void(const MaintenanceRun&)> run;
+};
+
+// One background thread that runs housekeeping off the request path:
+// the due task with the best priority starts only while foreground load
+// is under the threshold, runs against a time budget, and is followed by
+// enough idle time to keep maintenance within cpu_share of one core.
+class MaintenanceScheduler {
+public:
+    MaintenanceScheduler(std::function<int()> foreground_load, MaintenanceConfig config = MaintenanceConfig());
+    ~MaintenanceScheduler(); // Cancels the running task and stops the thread
+
+    void add(MaintenanceTask task, bool run_now = false);
+    bool trigger(const std::string& name); // Due now; false if unknown
+
+    json to_json(); // Queue (soonest first) with per-task timings
+
+private:
+    struct Entry {
+        MaintenanceTask task;
+        std::chrono::steady_clock::time_point next_due;
+        bool waiting = false; // Due, held back by load (counted once per wait)
+        bool rerun = false;   // Triggered while running
+        uint64_t runs = 0, deferred = 0, stopped_early = 0, failures = 0;
+        double last_ms = 0, max_ms = 0, total_ms = 0;
+        std::chrono::steady_clock::time_point last_end;
+        std::string last_error;
+    };
+
+    void run();
+
+    const std::function<int()> load;
+    const MaintenanceConfig config;
+    CancelToken shutdown;
+
+    std::mutex mtx; // Guards everything below
+    std::condition_variable wake;
+    std::vector<std::unique_ptr<Entry>> tasks;
+    const Entry* running = nullptr;
+    std::chrono::steady_clock::time_point quiet_until;
+    bool stopping = false;
+
+    std::thread worker;
+};
+
+#endif
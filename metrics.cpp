@@ -0,0 +1,83 @@
+#include "metrics.h"
+#include <algorithm>
+
+using namespace std;
+
+// ==========================================
+// HISTOGRAM
+// ==========================================
+// Values below SUB get a bucket each; above that, bucket = (log2 of the
+// value) * SUB + the next two bits below the leading one.
+
+int LatencyHistogram::bucket_of(uint64_t us) {
+    if (us < (uint64_t)SUB) return (int)us;
+    int log2 = 63;
+    while (!(us >> log2)) log2--;
+    int sub = (int)((us >> (log2 - 2)) & (SUB - 1));
+    return min(BUCKETS - 1, (log2 - 1) * SUB + sub);
+}
+
+uint64_t LatencyHistogram::bucket_upper_us(int b) {
+    if (b < SUB) return (uint64_t)b;
+    int log2 = b / SUB + 1;
+    uint64_t sub = (uint64_t)(b % SUB);
+    return ((SUB + sub + 1) << (log2 - 2)) - 1;
+}
+
+void LatencyHistogram::record_us(uint64_t us) {
+    buckets[bucket_of(us)].fetch_add(1, memory_order_relaxed);
+    n.fetch_add(1, memory_order_relaxed);
+    sum_us.fetch_add(us, memory_order_relaxed);
+    uint64_t seen = max_us.load(memory_order_relaxed);
+    while (us > seen && !max_us.compare_exchange_weak(seen, us, memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::percentile_ms(double p) const {
+    uint64_t total = count();
+    if (total == 0) return 0;
+    uint64_t rank = (uint64_t)(p * (double)(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += buckets[b].load(memory_order_relaxed);
+        if (seen >= rank) return min(bucket_upper_us(b), max_us.load(memory_order_relaxed)) / 1000.0;
+    }
+    return max_us.load(memory_order_relaxed) / 1000.0;
+}
+
+json LatencyHistogram::to_json() const {
+    uint64_t total = count();
+    return {
+        {"count", total},
+        {"mean_ms", total ? sum_us.load(memory_order_relaxed) / 1000.0 / total : 0.0},
+        {"p50_ms", percentile_ms(0.50)},
+        {"p90_ms", percentile_ms(0.90)},
+        {"p99_ms", percentile_ms(0.99)},
+        {"max_ms", max_us.load(memory_order_relaxed) / 1000.0}
+    };
+}
+
+// ==========================================
+// REGISTRY
+// ==========================================
+
+LatencyHistogram& MetricsRegistry::histogram(const string& name) {
+    lock_guard<mutex> lock(mtx);
+    auto& slot = histograms[name];
+    if (!slot) slot.reset(new LatencyHistogram());
+    return *slot;
+}
+
+atomic<uint64_t>& MetricsRegistry::counter(const string& name) {
+    lock_guard<mutex> lock(mtx);
+    auto& slot = counters[name];
+    if (!slot) slot.reset(new atomic<uint64_t>(0));
+    return *slot;
+}
+
+json MetricsRegistry::to_json() {
+    lock_guard<mutex> lock(mtx);
+    json out = {{"histograms", json::object()}, {"counters", json::object()}};
+    for (const auto& h : histograms) out["histograms"][h.first] = h.second->to_json();
+    for (const auto& c : counters) out["counters"][c.first] = c.second->load(memory_order_relaxed);
+    return out;
+}
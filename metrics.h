@@ -0,0 +1,50 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Lock-free latency histogram. Buckets are log-linear (4 per power of two)
+// over microseconds, so percentiles are within 25% of the true value at
+// any scale, for a fixed 160 counters.
+class LatencyHistogram {
+public:
+    void record_us(uint64_t us);
+    void record_ms(double ms) { record_us(ms <= 0 ? 0 : (uint64_t)(ms * 1000.0)); }
+
+    uint64_t count() const { return n.load(std::memory_order_relaxed); }
+    double percentile_ms(double p) const; // p in [0, 1]; 0 when empty
+    json to_json() const;                 // count, mean and p50 / p90 / p99 / max in ms
+
+private:
+    static const int SUB = 4;                // Buckets per power of two
+    static const int BUCKETS = 40 * SUB;
+    static int bucket_of(uint64_t us);
+    static uint64_t bucket_upper_us(int b);
+
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> n{0}, sum_us{0}, max_us{0};
+};
+
+// Named histograms and counters, created on first use and never removed,
+// so references stay valid and hot paths touch only atomics.
+class MetricsRegistry {
+public:
+    LatencyHistogram& histogram(const std::string& name);
+    std::atomic<uint64_t>& counter(const std::string& name);
+    json to_json();
+
+private:
+    std::mutex mtx; // Guards the maps, not the values
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+    std::map<std::string, std::unique_ptr<std::atomic<uint64_t>>> counters;
+};
+
+#endif
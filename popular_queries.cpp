@@ -0,0 +1,73 @@
+#include "popular_queries.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+void PopularQueries::record(const string& key, const string& query) {
+    lock_guard<mutex> lock(mtx);
+    auto& e = entries[key];
+    e.query = query;
+    e.count++;
+    if (entries.size() <= 2 * capacity) return;
+
+    auto keep = ranked(capacity);
+    entries.clear();
+    for (auto& k : keep) {
+        k.second.count = max<uint64_t>(1, k.second.count / 2);
+        entries.emplace(move(k.first), move(k.second));
+    }
+}
+
+vector<pair<string, PopularQueries::Entry>> PopularQueries::ranked(size_t n) {
+    vector<pair<string, Entry>> all(entries.begin(), entries.end());
+    auto by_count = [](const pair<string, Entry>& a, const pair<string, Entry>& b) {
+        return a.second.count != b.second.count ? a.second.count > b.second.count : a.first < b.first;
+    };
+    if (all.size() > n) {
+        nth_element(all.begin(), all.begin() + (ptrdiff_t)n, all.end(), by_count);
+        all.resize(n);
+    }
+    sort(all.begin(), all.end(), by_count);
+    return all;
+}
+
+vector<string> PopularQueries::top(size_t n) {
+    lock_guard<mutex> lock(mtx);
+    vector<string> out;
+    for (const auto& e : ranked(n)) out.push_back(e.second.query);
+    return out;
+}
+
+bool PopularQueries::save(const string& path, size_t n) {
+    vector<string> queries = top(n);
+    string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, ios::trunc);
+        for (const auto& q : queries) out << q << '\n';
+        if (!out) return false;
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(path.c_str()); // Windows will not rename over a file
+        return rename(tmp.c_str(), path.c_str()) == 0;
+    }
+    return true;
+}
+
+size_t PopularQueries::load(const string& path) {
+    ifstream in(path);
+    vector<string> queries;
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty()) queries.push_back(line);
+    }
+    // The file has no keys: the query string stands in until it is searched again
+    lock_guard<mutex> lock(mtx);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto& e = entries["saved:" + queries[i]];
+        e.query = queries[i];
+        e.count = max<uint64_t>(e.count, queries.size() - i);
+    }
+    return queries.size();
+}
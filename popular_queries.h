@@ -0,0 +1,38 @@
+#ifndef POPULAR_QUERIES_H
+#define POPULAR_QUERIES_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The most frequent /api/search query strings, kept so a restarted server
+// can warm its caches with them. Bounded: past twice the capacity the table
+// keeps its top `capacity` entries and halves their counts, so the list
+// follows recent traffic.
+class PopularQueries {
+public:
+    explicit PopularQueries(size_t capacity = 256) : capacity(capacity) {}
+
+    // `key` identifies the search (SearchRequest::key()), `query` is the
+    // query string that produced it
+    void record(const std::string& key, const std::string& query);
+    std::vector<std::string> top(size_t n); // Query strings, most frequent first
+
+    bool save(const std::string& path, size_t n); // One query string per line, most frequent first
+    size_t load(const std::string& path);          // Seeds the counts from a saved list
+
+private:
+    struct Entry {
+        std::string query;
+        uint64_t count;
+    };
+    std::vector<std::pair<std::string, Entry>> ranked(size_t n); // Caller holds mtx
+
+    std::mutex mtx;
+    size_t capacity;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+#endif
@@ -0,0 +1,317 @@
+#include "price_history.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+using namespace std;
+
+// A block is sealed once its encoding reaches this size (~80 changes)
+static const size_t BLOCK_BYTES = 256;
+
+// ==========================================
+// ENCODING
+// ==========================================
+// Frame in the file: u32 little-endian payload length, then the payload:
+// varint id length, id, varint block index, zigzag initial price, points.
+// Points: varint time, zigzag price; then varint time delta, zigzag price
+// delta for each later one.
+
+static void put_varint(string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out += (char)(v | 0x80);
+        v >>= 7;
+    }
+    out += (char)v;
+}
+
+static bool get_varint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = (uint8_t)*p++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+// Decodes a block's points (into `out` if given); false if malformed
+static bool decode_points(const string& bytes, vector<PriceHistory::Point>* out,
+                          int64_t& first_time, int64_t& last_time, int& last_price, uint32_t& count) {
+    const char* p = bytes.data();
+    const char* end = p + bytes.size();
+    int64_t time = 0, price = 0;
+    count = 0;
+    while (p < end) {
+        uint64_t t, d;
+        if (!get_varint(p, end, t) || !get_varint(p, end, d)) return false;
+        time += (int64_t)t;
+        price += unzigzag(d);
+        if (count++ == 0) first_time = time;
+        if (out) out->push_back({time, (int)price});
+    }
+    last_time = time;
+    last_price = (int)price;
+    return true;
+}
+
+static string encode_frame(const string& id, uint32_t seq, int initial_price, const string& points) {
+    string payload;
+    put_varint(payload, id.size());
+    payload += id;
+    put_varint(payload, seq);
+    put_varint(payload, zigzag(initial_price));
+    payload += points;
+
+    uint32_t n = (uint32_t)payload.size();
+    string frame;
+    for (int i = 0; i < 4; ++i) frame += (char)((n >> (8 * i)) & 0xFF);
+    return frame + payload;
+}
+
+static bool decode_frame(const string& payload, string& id, uint32_t& seq, int& initial_price, string& points) {
+    const char* p = payload.data();
+    const char* end = p + payload.size();
+    uint64_t len, s, init;
+    if (!get_varint(p, end, len) || (uint64_t)(end - p) < len) return false;
+    id.assign(p, (size_t)len);
+    p += len;
+    if (!get_varint(p, end, s) || !get_varint(p, end, init)) return false;
+    seq = (uint32_t)s;
+    initial_price = (int)unzigzag(init);
+    points.assign(p, end);
+    return true;
+}
+
+// ==========================================
+// STORE
+// ==========================================
+
+PriceHistory::PriceHistory(const string& file_path, size_t memory_budget)
+    : path(file_path), budget(memory_budget) {
+    load();
+}
+
+PriceHistory::~PriceHistory() {
+    flush();
+}
+
+void PriceHistory::set_memory_budget(size_t bytes) {
+    lock_guard<mutex> lock(mtx);
+    budget = bytes;
+    enforce_budget();
+}
+
+void PriceHistory::load() {
+    { ofstream touch(path, ios::binary | ios::app); } // Create if missing
+    file.open(path, ios::binary | ios::in | ios::out);
+
+    int64_t pos = 0;
+    char header[4];
+    string payload, id, points;
+    while (file.read(header, 4)) {
+        uint32_t len = 0;
+        for (int i = 0; i < 4; ++i) len |= (uint32_t)(uint8_t)header[i] << (8 * i);
+        payload.resize(len);
+        if (!file.read(&payload[0], len)) break;
+
+        uint32_t seq;
+        int initial;
+        Block meta;
+        if (!decode_frame(payload, id, seq, initial, points) ||
+            !decode_points(points, nullptr, meta.first_time, meta.last_time, meta.last_price, meta.count)) break;
+
+        Series& s = series[id];
+        s.initial_price = initial;
+        if (seq >= s.blocks.size()) s.blocks.resize(seq + 1);
+        Block& b = s.blocks[seq];
+        n_points = n_points - b.count + meta.count; // A later frame of a block replaces the earlier one
+        meta.offset = pos + 4;
+        meta.length = len;
+        // Only the last block of each flight stays in memory, for appends
+        meta.resident = seq + 1 == s.blocks.size();
+        if (meta.resident) meta.bytes = points;
+        b = move(meta);
+        if (seq > 0 && s.blocks[seq - 1].resident) {
+            string().swap(s.blocks[seq - 1].bytes);
+            s.blocks[seq - 1].resident = s.blocks[seq - 1].offset < 0;
+        }
+        pos += 4 + (int64_t)len;
+    }
+    file.clear();
+
+    // Cut a frame torn by a crash, so appends continue from a clean end
+    error_code ec;
+    if ((int64_t)filesystem::file_size(path, ec) > pos && !ec) {
+        file.close();
+        filesystem::resize_file(path, (uintmax_t)pos, ec);
+        file.open(path, ios::binary | ios::in | ios::out);
+    }
+    file_size = pos;
+}
+
+bool PriceHistory::write_frame(const string& id, const Series& s, uint32_t seq, Block& b) {
+    string frame = encode_frame(id, seq, s.initial_price, b.bytes);
+    file.clear();
+    file.seekp(file_size);
+    file.write(frame.data(), (streamsize)frame.size());
+    file.flush();
+    if (!file) return false;
+    b.offset = file_size + 4;
+    b.length = (uint32_t)frame.size() - 4;
+    file_size += (int64_t)frame.size();
+    return true;
+}
+
+bool PriceHistory::read_block(const Block& b, string& bytes) {
+    if (b.resident) {
+        bytes = b.bytes;
+        return true;
+    }
+    string payload(b.length, '\0'), id;
+    file.clear();
+    file.seekg(b.offset);
+    if (!file.read(&payload[0], b.length)) return false;
+    uint32_t seq;
+    int initial;
+    n_cold_reads++;
+    return decode_frame(payload, id, seq, initial, bytes);
+}
+
+// Drops the oldest sealed blocks from memory; they are already on disk
+void PriceHistory::enforce_budget() {
+    while (sealed_bytes > budget && !sealed.empty()) {
+        Block& b = series[sealed.front().first].blocks[sealed.front().second];
+        sealed.pop_front();
+        sealed_bytes -= b.bytes.size();
+        if (b.offset < 0) continue; // Write failed; keep it in memory
+        string().swap(b.bytes);
+        b.resident = false;
+    }
+}
+
+void PriceHistory::record(const string& id, int old_price, int new_price, int64_t time) {
+    lock_guard<mutex> lock(mtx);
+    auto it = series.find(id);
+    if (it == series.end()) {
+        it = series.emplace(id, Series()).first;
+        it->second.initial_price = old_price;
+    }
+    Series& s = it->second;
+
+    if (s.blocks.empty() || s.blocks.back().bytes.size() >= BLOCK_BYTES) {
+        if (!s.blocks.empty()) {
+            // Seal: its final frame goes to disk now, so it can be spilled any time
+            uint32_t seq = (uint32_t)s.blocks.size() - 1;
+            write_frame(id, s, seq, s.blocks.back());
+            sealed.push_back({id, seq});
+            sealed_bytes += s.blocks.back().bytes.size();
+        }
+        s.blocks.emplace_back();
+    }
+
+    Block& b = s.blocks.back();
+    if (b.count == 0) {
+        put_varint(b.bytes, (uint64_t)max<int64_t>(0, time));
+        put_varint(b.bytes, zigzag(new_price));
+        b.first_time = b.last_time = max<int64_t>(0, time);
+    } else {
+        time = max(time, b.last_time); // Keep the chain time-ordered
+        put_varint(b.bytes, (uint64_t)(time - b.last_time));
+        put_varint(b.bytes, zigzag((int64_t)new_price - b.last_price));
+        b.last_time = time;
+    }
+    b.last_price = new_price;
+    b.count++;
+    n_points++;
+    dirty.insert(id);
+    enforce_budget();
+}
+
+bool PriceHistory::query(const string& id, int64_t from, int64_t to, size_t limit,
+                         int& initial_price, vector<Point>& out) {
+    lock_guard<mutex> lock(mtx);
+    auto it = series.find(id);
+    if (it == series.end()) return false;
+    initial_price = it->second.initial_price;
+
+    vector<Point> points;
+    string bytes;
+    for (const Block& b : it->second.blocks) {
+        if (b.count == 0 || b.last_time < from || b.first_time > to) continue;
+        if (!read_block(b, bytes)) continue;
+        points.clear();
+        int64_t first, last;
+        int last_price;
+        uint32_t count;
+        decode_points(bytes, &points, first, last, last_price, count);
+        for (const auto& p : points) {
+            if (p.time >= from && p.time <= to) out.push_back(p);
+        }
+    }
+    if (limit > 0 && out.size() > limit) out.erase(out.begin(), out.end() - (ptrdiff_t)limit);
+    return true;
+}
+
+void PriceHistory::flush() {
+    lock_guard<mutex> lock(mtx);
+    for (const auto& id : dirty) {
+        Series& s = series[id];
+        write_frame(id, s, (uint32_t)s.blocks.size() - 1, s.blocks.back());
+    }
+    dirty.clear();
+}
+
+void PriceHistory::compact() {
+    lock_guard<mutex> lock(mtx);
+    string tmp_path = path + ".tmp";
+    ofstream out(tmp_path, ios::binary | ios::trunc);
+
+    // New offsets are applied only once the new file is in place
+    vector<pair<Block*, pair<int64_t, uint32_t>>> moved;
+    int64_t pos = 0;
+    string bytes;
+    for (auto& entry : series) {
+        Series& s = entry.second;
+        for (uint32_t seq = 0; seq < s.blocks.size(); ++seq) {
+            Block& b = s.blocks[seq];
+            if (!read_block(b, bytes)) return;
+            string frame = encode_frame(entry.first, seq, s.initial_price, bytes);
+            out.write(frame.data(), (streamsize)frame.size());
+            moved.push_back({&b, {pos + 4, (uint32_t)frame.size() - 4}});
+            pos += (int64_t)frame.size();
+        }
+    }
+    out.close();
+    if (!out) return;
+
+    file.close();
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(path.c_str()); // Windows will not rename over a file
+        rename(tmp_path.c_str(), path.c_str());
+    }
+    file.open(path, ios::binary | ios::in | ios::out);
+    for (auto& m : moved) {
+        m.first->offset = m.second.first;
+        m.first->length = m.second.second;
+    }
+    file_size = pos;
+    dirty.clear(); // Every open block was just written
+}
+
+PriceHistory::Stats PriceHistory::stats() {
+    lock_guard<mutex> lock(mtx);
+    Stats st = {series.size(), 0, 0, 0, (size_t)file_size, 0, n_points, n_cold_reads};
+    for (const auto& entry : series) {
+        for (const auto& b : entry.second.blocks) {
+            st.blocks++;
+            if (b.offset >= 0) st.live_bytes += 4 + b.length;
+            if (!b.resident) continue;
+            st.resident_blocks++;
+            st.memory_bytes += b.bytes.size();
+        }
+    }
+    return st;
+}
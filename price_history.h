@@ -0,0 +1,86 @@
+#ifndef PRICE_HISTORY_H
+#define PRICE_HISTORY_H
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Append-only fare history per flight, kept out of the main JSON file.
+// Each flight's changes are a chain of small time-ordered blocks; a block
+// stores its first (time, price) as varints and every later point as a
+// varint time delta and a zigzag varint price delta, so a change costs 2-4
+// bytes. Full blocks are written to the history file as soon as they are
+// sealed and stay in memory only while the sealed bytes fit the budget;
+// older ones are dropped and read back from the file by queries. The block
+// still being filled is written by flush() (JsonDB::save()) as a new frame
+// that supersedes its previous one; compact() drops the superseded frames.
+class PriceHistory {
+public:
+    explicit PriceHistory(const std::string& path, size_t memory_budget = 8u << 20);
+    ~PriceHistory(); // flush()
+
+    void set_memory_budget(size_t bytes); // For sealed blocks; open blocks are always resident
+
+    // Flight `id` went from old_price to new_price at `time` (unix seconds)
+    void record(const std::string& id, int old_price, int new_price, int64_t time);
+
+    struct Point {
+        int64_t time;
+        int price;
+    };
+    // Changes with from <= time <= to, oldest first (the newest `limit` when
+    // there are more), and the price before the first recorded change.
+    // false if the flight has no history.
+    bool query(const std::string& id, int64_t from, int64_t to, size_t limit,
+               int& initial_price, std::vector<Point>& out);
+
+    void flush();   // Writes open blocks changed since the last flush
+    void compact(); // Rewrites the file with only the live frame of each block
+
+    struct Stats {
+        size_t flights, blocks, resident_blocks, memory_bytes;
+        size_t file_bytes, live_bytes; // live: the frames compact() would keep
+        uint64_t points, cold_reads;
+    };
+    Stats stats();
+
+private:
+    struct Block {
+        int64_t first_time = 0, last_time = 0;
+        int last_price = 0;    // Base of the next delta
+        uint32_t count = 0;
+        std::string bytes;     // Encoded points, while resident
+        bool resident = true;
+        int64_t offset = -1;   // Of its live frame in the file (-1 = not written)
+        uint32_t length = 0;   // Frame payload size
+    };
+    struct Series {
+        int initial_price = 0;
+        std::vector<Block> blocks;
+    };
+
+    void load();
+    bool write_frame(const std::string& id, const Series& s, uint32_t seq, Block& b); // Caller holds mtx
+    bool read_block(const Block& b, std::string& bytes);                             // Caller holds mtx
+    void enforce_budget();                                                            // Caller holds mtx
+
+    const std::string path;
+    size_t budget;
+
+    std::mutex mtx; // Guards everything below
+    std::fstream file;
+    int64_t file_size = 0;
+    std::unordered_map<std::string, Series> series;
+    std::unordered_set<std::string> dirty;                 // Open block changed since flush()
+    std::deque<std::pair<std::string, uint32_t>> sealed;   // Resident sealed blocks, oldest first
+    size_t sealed_bytes = 0;
+    uint64_t n_points = 0, n_cold_reads = 0;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+// Slot keys
+static const uint64_t EMPTY = 0;     // Never used: ends a probe
+static const uint64_t TOMBSTONE = 1; // Swept: probes continue past it, claims reuse it
+// Slot state: last refill (ms since epoch) above the balance in milli-tokens
+static const uint64_t DEAD = ~0ull;  // Being swept or not yet initialised
+static const int BALANCE_BITS = 24;
+static const uint64_t BALANCE_MASK = (1ull << BALANCE_BITS) - 1;
+
+static uint64_t pack(uint64_t last_ms, uint64_t balance) {
+    return (last_ms << BALANCE_BITS) | balance;
+}
+
+// Finalizer from splitmix64, so nearby strings land in unrelated slots
+static uint64_t mix(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27; x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x < 2 ? x + 2 : x; // Clear of EMPTY and TOMBSTONE
+}
+
+RateLimiter::RateLimiter(const RateLimitConfig& config)
+    : rate((uint64_t)max(0, config.tokens_per_second)),
+      capacity(min<uint64_t>(BALANCE_MASK, 1000ull * (uint64_t)(config.burst > 0 ? config.burst
+                                                      : max(config.tokens_per_second, config.search_cost)))),
+      // Never sweep a bucket that would not have refilled by then
+      idle_ms(max<uint64_t>(1000ull * (uint64_t)max(1, config.idle_seconds), rate ? capacity / rate : 0)),
+      epoch(chrono::steady_clock::now()) {
+    if (!enabled()) return;
+    for (auto& shard : shards) shard.slots.reset(new Slot[SLOTS]);
+}
+
+uint64_t RateLimiter::now_ms() const {
+    return (uint64_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - epoch).count();
+}
+
+uint64_t RateLimiter::refill(uint64_t state, uint64_t now, uint64_t& last) const {
+    last = state >> BALANCE_BITS;
+    uint64_t balance = state & BALANCE_MASK;
+    if (now <= last) return balance; // Another thread refilled a moment later
+    uint64_t elapsed = now - last;
+    last = now;
+    if (elapsed >= capacity / rate + 1) return capacity;
+    return min(capacity, balance + elapsed * rate);
+}
+
+// ==========================================
+// ADMISSION
+// ==========================================
+
+bool RateLimiter::allow(const string& client, int cost, uint64_t& retry_after_ms) {
+    retry_after_ms = 0;
+    if (!enabled() || cost <= 0) return true;
+
+    uint64_t hash = mix(std::hash<string>()(client));
+    Shard& shard = shards[hash % SHARDS];
+    uint64_t now = now_ms();
+    uint64_t need = min<uint64_t>(capacity, 1000ull * (uint64_t)cost);
+    maybe_sweep(now);
+
+    // A few rounds, for the moment a slot is being swept or claimed
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        Slot* slot = find_or_claim(shard, hash, now);
+        if (!slot) break;
+
+        uint64_t state = slot->state.load(memory_order_acquire);
+        while (state != DEAD) {
+            uint64_t last;
+            uint64_t balance = refill(state, now, last);
+            if (balance < need) {
+                retry_after_ms = (need - balance + rate - 1) / rate;
+                n_rejected.fetch_add(1, memory_order_relaxed);
+                return false;
+            }
+            if (slot->state.compare_exchange_weak(state, pack(last, balance - need), memory_order_acq_rel)) {
+                n_allowed.fetch_add(1, memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    n_table_full.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+// The slot holding `hash`, or a free one claimed for it with a full bucket.
+// Two racing first requests from one client can claim two slots; the
+// client then briefly has two buckets until one goes idle.
+RateLimiter::Slot* RateLimiter::find_or_claim(Shard& shard, uint64_t hash, uint64_t now) {
+    size_t start = (size_t)(hash / SHARDS);
+    for (int round = 0; round < 2; ++round) {
+        Slot* free_slot = nullptr;
+        uint64_t free_key = EMPTY;
+        for (int i = 0; i < PROBE; ++i) {
+            Slot& slot = shard.slots[(start + i) & (SLOTS - 1)];
+            uint64_t key = slot.key.load(memory_order_acquire);
+            if (key == hash) return &slot;
+            if ((key == TOMBSTONE || key == EMPTY) && !free_slot) {
+                free_slot = &slot;
+                free_key = key;
+            }
+            if (key == EMPTY) break; // End of the chain
+        }
+        if (!free_slot) return nullptr;
+        if (free_slot->key.compare_exchange_strong(free_key, hash, memory_order_acq_rel)) {
+            free_slot->state.store(pack(now, capacity), memory_order_release);
+            n_clients.fetch_add(1, memory_order_relaxed);
+            return free_slot;
+        }
+        // Lost the slot to another client (or to this one): look again
+    }
+    return nullptr;
+}
+
+// ==========================================
+// SWEEP
+// ==========================================
+
+void RateLimiter::maybe_sweep(uint64_t now) {
+    uint64_t due = next_sweep_ms.load(memory_order_relaxed);
+    if (now < due) return;
+    if (!next_sweep_ms.compare_exchange_strong(due, now + max<uint64_t>(1, idle_ms / SHARDS), memory_order_relaxed)) return;
+    sweep(shards[sweep_cursor.fetch_add(1, memory_order_relaxed) % SHARDS], now);
+}
+
+void RateLimiter::sweep(Shard& shard, uint64_t now) {
+    for (int i = 0; i < SLOTS; ++i) {
+        Slot& slot = shard.slots[i];
+        if (slot.key.load(memory_order_acquire) < 2) continue;
+        uint64_t state = slot.state.load(memory_order_acquire);
+        if (state == DEAD || (state >> BALANCE_BITS) + idle_ms > now) continue;
+        // Fails if the client came back meanwhile; takers seeing DEAD re-probe
+        if (!slot.state.compare_exchange_strong(state, DEAD, memory_order_acq_rel)) continue;
+        slot.key.store(TOMBSTONE, memory_order_release);
+        n_clients.fetch_sub(1, memory_order_relaxed);
+        n_evicted.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+RateLimiter::Stats RateLimiter::stats() const {
+    return {n_allowed.load(), n_rejected.load(), n_table_full.load(), n_clients.load(), n_evicted.load()};
+}
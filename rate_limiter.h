@@ -0,0 +1,71 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct RateLimitConfig {
+    int tokens_per_second = 0; // Refill rate per client; 0 disables limiting
+    int burst = 0;             // Bucket size; 0 = max(tokens_per_second, search_cost)
+    int search_cost = 10;      // Tokens per /api/search (other routes cost 1)
+    int idle_seconds = 300;    // Buckets untouched this long are swept
+};
+
+// Per-client token buckets. Clients are hashed (64 bit) into a fixed
+// sharded open-addressed table whose slots are two atomics: the key hash and
+// the bucket state (last refill time and balance packed in one word), so
+// allow() is a probe plus a compare-exchange with no locks. Buckets refill
+// lazily on use. Every allow() call may sweep one shard of idle buckets, a
+// full pass per idle period, so no thread is needed.
+//
+// When a client's probe window is full the request is let through (and
+// counted) rather than rejected.
+class RateLimiter {
+public:
+    explicit RateLimiter(const RateLimitConfig& config);
+
+    bool enabled() const { return rate > 0; }
+
+    // Takes `cost` tokens from the client's bucket. On false,
+    // retry_after_ms is how long until the bucket holds enough.
+    bool allow(const std::string& client, int cost, uint64_t& retry_after_ms);
+
+    struct Stats {
+        uint64_t allowed, rejected, table_full, clients, evicted;
+    };
+    Stats stats() const;
+
+private:
+    static const int SHARDS = 16;
+    static const int SLOTS = 8192; // Per shard, power of two
+    static const int PROBE = 32;
+
+    struct Slot {
+        std::atomic<uint64_t> key{0};      // EMPTY, TOMBSTONE or the client hash
+        std::atomic<uint64_t> state{~0ull}; // pack(last_ms, milli-tokens) or DEAD
+    };
+    struct Shard {
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    uint64_t now_ms() const;
+    uint64_t refill(uint64_t state, uint64_t now, uint64_t& last) const; // Balance in milli-tokens
+    Slot* find_or_claim(Shard& shard, uint64_t hash, uint64_t now);
+    void maybe_sweep(uint64_t now);
+    void sweep(Shard& shard, uint64_t now);
+
+    const uint64_t rate;       // Milli-tokens per millisecond == tokens per second
+    const uint64_t capacity;   // Milli-tokens
+    const uint64_t idle_ms;
+    const std::chrono::steady_clock::time_point epoch;
+
+    Shard shards[SHARDS];
+    std::atomic<uint64_t> next_sweep_ms{0};
+    std::atomic<uint32_t> sweep_cursor{0};
+    std::atomic<uint64_t> n_allowed{0}, n_rejected{0}, n_table_full{0}, n_clients{0}, n_evicted{0};
+};
+
+#endif
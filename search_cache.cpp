@@ -0,0 +1,81 @@
+#include "search_cache.h"
+#include <algorithm>
+
+using namespace std;
+
+// ==========================================
+// REQUESTS
+// ==========================================
+
+static string joined(vector<string> items, bool sorted) {
+    if (sorted) sort(items.begin(), items.end());
+    string out;
+    for (const auto& s : items) out += s + ',';
+    return out;
+}
+
+string SearchRequest::key() const {
+    const SearchConstraints& c = constraints;
+    return joined(srcs, true) + '|' + joined(dsts, true) + '|' + date + '|' + to_string(k) + '|' +
+           (fast ? "fast:" + to_string(beam) : string("exact")) + '|' + joined(c.airlines, true) + '|' +
+           to_string(c.max_price) + '|' + to_string(c.max_stops) + '|' + joined(c.avoid, true) + '|' +
+           joined(c.via, true) + '|' + to_string(c.seats);
+}
+
+json run_search(JsonDB& db, const SearchRequest& r, SearchStats* stats, const RouteCallback& on_route,
+                const CancelToken* cancel) {
+    if (!r.fast) return db.find_smart_routes(r.srcs, r.dsts, r.date, r.k, r.constraints, stats, on_route, cancel);
+
+    json routes = db.find_fast_routes(r.srcs, r.dsts, r.date, r.k, r.beam, r.constraints, stats, cancel);
+    if (on_route) for (const auto& route : routes) on_route(route);
+    return routes;
+}
+
+// ==========================================
+// RESPONSE CACHE
+// ==========================================
+
+bool ResponseCache::fresh(const Entry& e, uint64_t version) const {
+    return e.version == version && chrono::steady_clock::now() - e.stored < ttl;
+}
+
+bool ResponseCache::get(const string& key, uint64_t version, Hit& out) {
+    lock_guard<mutex> lock(mtx);
+    auto it = entries.find(key);
+    if (it == entries.end() || !fresh(*it->second, version)) {
+        n_misses++;
+        return false;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    out.body = it->second->body;
+    out.prefetched = it->second->prefetched;
+    n_hits++;
+    if (out.prefetched) n_prefetched_hits++;
+    return true;
+}
+
+bool ResponseCache::contains(const string& key, uint64_t version) {
+    lock_guard<mutex> lock(mtx);
+    auto it = entries.find(key);
+    return it != entries.end() && fresh(*it->second, version);
+}
+
+void ResponseCache::put(const string& key, uint64_t version, string body, bool prefetched) {
+    lock_guard<mutex> lock(mtx);
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        lru.erase(it->second);
+        entries.erase(it);
+    }
+    lru.push_front({key, version, chrono::steady_clock::now(), move(body), prefetched});
+    entries[key] = lru.begin();
+    if (lru.size() > capacity) {
+        entries.erase(lru.back().key);
+        lru.pop_back();
+    }
+}
+
+ResponseCache::Stats ResponseCache::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {lru.size(), n_hits, n_prefetched_hits, n_misses};
+}
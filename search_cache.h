@@ -0,0 +1,77 @@
+#ifndef SEARCH_CACHE_H
+#define SEARCH_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "jsondb.h"
+
+// A fully resolved /api/search call: what the engine is asked to run
+struct SearchRequest {
+    std::vector<std::string> srcs, dsts;
+    std::string date;
+    SearchConstraints constraints;
+    bool fast = false; // mode=fast (beam search)
+    int beam = 32;
+    int k = 5;
+    int timeout_ms = 0; // timeout_ms; 0 = none. Not part of key()
+
+    // Canonical cache key; equal for requests that return the same routes
+    std::string key() const;
+};
+
+// Runs `r` on the exact or beam engine. The exact engine streams routes to
+// on_route as it finds them; the beam engine only knows its order at the
+// end, so it reports them all then. A tripped cancel token leaves partial
+// results and stats->cancelled set; they must not be cached.
+json run_search(JsonDB& db, const SearchRequest& r, SearchStats* stats = nullptr,
+                const RouteCallback& on_route = nullptr, const CancelToken* cancel = nullptr);
+
+// Bounded LRU of serialized /api/search responses. An entry is served only
+// while it is younger than the TTL (seat counts move without a data
+// version) and was computed on the current version of the data for its
+// date (JsonDB::version(date)).
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t capacity = 1024, std::chrono::seconds ttl = std::chrono::seconds(30))
+        : capacity(capacity), ttl(ttl) {}
+
+    struct Hit {
+        std::string body;
+        bool prefetched; // Stored by the speculative prefetcher
+    };
+
+    bool get(const std::string& key, uint64_t version, Hit& out);
+    bool contains(const std::string& key, uint64_t version); // Fresh entry present (no LRU touch)
+    void put(const std::string& key, uint64_t version, std::string body, bool prefetched);
+
+    struct Stats {
+        size_t entries;
+        uint64_t hits, prefetched_hits, misses;
+    };
+    Stats stats();
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t version;
+        std::chrono::steady_clock::time_point stored;
+        std::string body;
+        bool prefetched;
+    };
+
+    bool fresh(const Entry& e, uint64_t version) const;
+
+    std::mutex mtx;
+    size_t capacity;
+    std::chrono::seconds ttl;
+    std::list<Entry> lru; // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+    uint64_t n_hits = 0, n_prefetched_hits = 0, n_misses = 0;
+};
+
+#endif
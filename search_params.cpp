@@ -0,0 +1,130 @@
+#include "search_params.h"
+
+using namespace std;
+
+// ==========================================
+// SEARCH PARAMETERS
+// ==========================================
+
+vector<string> split_csv(const char* value) {
+    vector<string> out;
+    if (!value) return out;
+    string item;
+    for (const char* p = value; ; ++p) {
+        if (*p == ',' || *p == '\0') {
+            if (!item.empty()) out.push_back(item);
+            item.clear();
+            if (*p == '\0') break;
+        } else {
+            item += *p;
+        }
+    }
+    return out;
+}
+
+// Reads one end of a search: <prefix> (airport code), <prefix>_city,
+// <prefix>_radius_km and <prefix>_lat/<prefix>_lng. Throws on bad numbers.
+static PlaceQuery parse_place(const ParamLookup& param, const string& prefix) {
+    PlaceQuery place;
+    if (const char* v = param(prefix)) place.code = v;
+    if (const char* v = param(prefix + "_city")) place.city = v;
+    if (const char* v = param(prefix + "_radius_km")) place.radius_km = stod(v);
+    const char* lat = param(prefix + "_lat");
+    const char* lng = param(prefix + "_lng");
+    if (lat && lng) {
+        place.has_coords = true;
+        place.lat = stod(lat);
+        place.lng = stod(lng);
+    }
+    return place;
+}
+
+static bool is_place_set(const PlaceQuery& place) {
+    return !place.code.empty() || !place.city.empty() || (place.has_coords && place.radius_km > 0);
+}
+
+int parse_search_params(JsonDB& db, const ParamLookup& param, SearchRequest& r, string& error) {
+    r.date = param("date") ? param("date") : "2025-12-01";
+
+    PlaceQuery from, to;
+    SearchConstraints& c = r.constraints;
+    try {
+        from = parse_place(param, "from");
+        to = parse_place(param, "to");
+        if (param("max_price")) c.max_price = stoi(param("max_price"));
+        if (param("max_stops")) c.max_stops = stoi(param("max_stops"));
+        if (param("beam")) r.beam = stoi(param("beam"));
+        if (param("seats")) c.seats = stoi(param("seats"));
+        if (param("timeout_ms")) r.timeout_ms = stoi(param("timeout_ms"));
+    } catch (...) { error = "Invalid parameters"; return 400; }
+    if (!is_place_set(from) || !is_place_set(to)) { error = "Missing parameters"; return 400; }
+
+    // mode=fast trades exactness for bounded latency (beam search)
+    string mode = param("mode") ? param("mode") : "exact";
+    if (mode != "exact" && mode != "fast") { error = "Invalid mode"; return 400; }
+    r.fast = mode == "fast";
+
+    c.airlines = split_csv(param("airline"));
+    c.avoid = split_csv(param("avoid"));
+    c.via = split_csv(param("via"));
+    if (!c.via_fits()) { error = "Too many via airports (max 32)"; return 400; }
+
+    r.srcs = db.resolve_place(from);
+    r.dsts = db.resolve_place(to);
+    if (r.srcs.empty() || r.dsts.empty()) { error = "No matching airports"; return 404; }
+    return 0;
+}
+
+// ==========================================
+// QUERY STRINGS
+// ==========================================
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// '+' is a space and %XX a byte; a malformed escape is kept as it is
+static string url_decode(const string& s) {
+    string out;
+    for (size_t i = 0; i < s.size(); ++i) {
+        int hi, lo;
+        if (s[i] == '+') {
+            out += ' ';
+        } else if (s[i] == '%' && i + 2 < s.size() && (hi = hex_value(s[i + 1])) >= 0 &&
+                   (lo = hex_value(s[i + 2])) >= 0) {
+            out += (char)(hi * 16 + lo);
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+QueryParams::QueryParams(const string& query) {
+    size_t pos = !query.empty() && query[0] == '?' ? 1 : 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == string::npos) end = query.size();
+        string item = query.substr(pos, end - pos);
+        if (!item.empty()) {
+            size_t eq = item.find('=');
+            string name = url_decode(item.substr(0, eq));
+            string value = eq == string::npos ? "" : url_decode(item.substr(eq + 1));
+            values.emplace(name, value);
+        }
+        pos = end + 1;
+    }
+}
+
+const char* QueryParams::get(const string& name) const {
+    auto it = values.find(name);
+    return it == values.end() ? nullptr : it->second.c_str();
+}
+
+ParamLookup QueryParams::lookup() const {
+    return [this](const string& name) { return get(name); };
+}
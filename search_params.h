@@ -0,0 +1,34 @@
+#ifndef SEARCH_PARAMS_H
+#define SEARCH_PARAMS_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "search_cache.h"
+
+// Value of a request parameter, or nullptr when it is absent
+typedef std::function<const char*(const std::string& name)> ParamLookup;
+
+// Reads the /api/search parameters (from/from_city/from_radius_km/from_lat/
+// from_lng, the same for "to", date, airline, max_price, max_stops, avoid,
+// via, mode, beam, seats, timeout_ms) into a resolved SearchRequest.
+// Returns 0, or the HTTP status to answer with and `error` as the body.
+int parse_search_params(JsonDB& db, const ParamLookup& param, SearchRequest& r, std::string& error);
+
+// Splits a comma separated value ("DEL,BOM") into its non-empty parts
+std::vector<std::string> split_csv(const char* value);
+
+// A decoded query string ("from=DEL&to=New%20Delhi"), for callers outside
+// the HTTP server. A leading '?' is skipped; the first of repeated keys wins.
+class QueryParams {
+public:
+    explicit QueryParams(const std::string& query);
+    const char* get(const std::string& name) const;
+    ParamLookup lookup() const;
+
+private:
+    std::unordered_map<std::string, std::string> values;
+};
+
+#endif
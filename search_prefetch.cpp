@@ -0,0 +1,150 @@
+#include "search_prefetch.h"
+#include <cstdio>
+#include <ctime>
+
+using namespace std;
+
+// "2025-12-01" shifted by `days` (calendar aware); empty if unparsable
+static string shift_date(const string& date, int days) {
+    tm t = {};
+    if (sscanf(date.c_str(), "%d-%d-%d", &t.tm_year, &t.tm_mon, &t.tm_mday) != 3) return "";
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    t.tm_mday += days;
+    t.tm_hour = 12; // Clear of DST edges
+    if (mktime(&t) == (time_t)-1) return "";
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y-%m-%d", &t);
+    return buf;
+}
+
+SearchPrefetcher::SearchPrefetcher(JsonDB& database, ResponseCache& response_cache, PrefetchConfig cfg)
+    : db(database), cache(response_cache), config(cfg) {
+    if (config.enabled) worker = thread(&SearchPrefetcher::run, this);
+}
+
+SearchPrefetcher::~SearchPrefetcher() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    shutdown.cancel();
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+SearchPrefetcher::Foreground::Foreground(SearchPrefetcher& p) : owner(p) {
+    owner.foreground.fetch_add(1);
+    lock_guard<mutex> lock(owner.mtx); // The worker checks foreground and sets running under it
+    if (owner.running) owner.running->cancel();
+}
+
+SearchPrefetcher::Foreground::~Foreground() {
+    if (owner.foreground.fetch_sub(1) == 1) {
+        lock_guard<mutex> lock(owner.mtx); // Pairs with the worker's wait
+        owner.wake.notify_all();
+    }
+}
+
+// ==========================================
+// QUEUEING
+// ==========================================
+
+void SearchPrefetcher::enqueue(SearchRequest r) {
+    if (r.date.empty()) return;
+    string key = r.key();
+    if (pending_keys.count(key)) return;
+    if (pending.size() >= config.max_pending) {
+        pending_keys.erase(pending.front().key());
+        pending.pop_front();
+        n_dropped++;
+    }
+    pending_keys.insert(key);
+    pending.push_back(move(r));
+    n_queued++;
+}
+
+void SearchPrefetcher::after_search(const SearchRequest& r) {
+    if (!config.enabled) return;
+    {
+        lock_guard<mutex> lock(mtx);
+        for (int delta : {1, -1}) {
+            SearchRequest next = r;
+            next.date = shift_date(r.date, delta);
+            enqueue(move(next));
+        }
+        for (int n = 1; n <= config.reverse_days; ++n) {
+            SearchRequest back = r;
+            swap(back.srcs, back.dsts);
+            back.date = shift_date(r.date, n);
+            enqueue(move(back));
+        }
+    }
+    wake.notify_all();
+}
+
+// ==========================================
+// WORKER
+// ==========================================
+// Waits for queued work and an idle foreground, spends one unit of the
+// per-second budget, and runs the oldest follow-up unless the cache
+// already has it. A foreground search that arrives meanwhile cancels it
+// (through `running`), waiting only for the label in progress, and the
+// follow-up goes back in the queue.
+
+void SearchPrefetcher::run() {
+    using clock = chrono::steady_clock;
+    auto window = clock::now();
+    int spent = 0;
+
+    unique_lock<mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || (!pending.empty() && foreground.load() == 0); });
+        if (stopping) break;
+
+        if (clock::now() - window >= chrono::seconds(1)) {
+            window = clock::now();
+            spent = 0;
+        }
+        if (spent >= config.max_per_second) {
+            wake.wait_until(lock, window + chrono::seconds(1), [&] { return stopping; });
+            continue;
+        }
+
+        SearchRequest r = move(pending.front());
+        pending.pop_front();
+        string key = r.key();
+        pending_keys.erase(key);
+        CancelToken preempt(&shutdown);
+        running = &preempt;
+        lock.unlock();
+
+        uint64_t version = db.version(r.date);
+        bool ran = false, cancelled = false;
+        if (!cache.contains(key, version)) {
+            SearchStats stats;
+            json routes = run_search(db, r, &stats, nullptr, &preempt);
+            cancelled = stats.cancelled;
+            if (!cancelled) cache.put(key, version, routes.dump(), true);
+            ran = true;
+        }
+
+        lock.lock();
+        running = nullptr;
+        if (cancelled) {
+            n_preempted++;
+            spent++;
+            if (!stopping) enqueue(move(r));
+        } else if (ran) {
+            n_run++;
+            spent++;
+        } else {
+            n_skipped++;
+        }
+    }
+}
+
+SearchPrefetcher::Stats SearchPrefetcher::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {pending.size(), n_queued, n_run, n_skipped, n_dropped, n_preempted};
+}
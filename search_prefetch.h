@@ -0,0 +1,78 @@
+#ifndef SEARCH_PREFETCH_H
+#define SEARCH_PREFETCH_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include "search_cache.h"
+
+struct PrefetchConfig {
+    bool enabled = true;
+    size_t max_pending = 32;  // Queued follow-ups; the oldest are dropped beyond this
+    int max_per_second = 20;  // Speculative searches run per second (the budget)
+    int reverse_days = 3;     // Return trips prefetched for D+1 .. D+reverse_days
+};
+
+// Speculative execution of likely follow-up searches. After a search for
+// (A, B, D) it queues (A, B, D-1), (A, B, D+1) and the return trips
+// (B, A, D+n), and one background thread runs them into the ResponseCache.
+// The thread only starts a search while no foreground search is in flight
+// (see Foreground), and never more than max_per_second of them; a
+// foreground search that arrives mid-run cancels the speculative one.
+class SearchPrefetcher {
+public:
+    SearchPrefetcher(JsonDB& db, ResponseCache& cache, PrefetchConfig config = PrefetchConfig());
+    ~SearchPrefetcher(); // Drops queued work and stops the thread
+
+    // Marks a foreground search for its lifetime; cancels the speculative
+    // search in flight, and speculative work waits until none are left
+    class Foreground {
+    public:
+        explicit Foreground(SearchPrefetcher& p);
+        ~Foreground();
+        Foreground(const Foreground&) = delete;
+        Foreground& operator=(const Foreground&) = delete;
+    private:
+        SearchPrefetcher& owner;
+    };
+
+    int foreground_searches() const { return foreground.load(); }
+
+    // Queues the likely follow-ups of a search a user just ran
+    void after_search(const SearchRequest& r);
+
+    struct Stats {
+        size_t pending;
+        uint64_t queued, run, skipped, dropped, preempted;
+    };
+    Stats stats();
+
+private:
+    void enqueue(SearchRequest r); // Caller holds mtx
+    void run();
+
+    JsonDB& db;
+    ResponseCache& cache;
+    const PrefetchConfig config;
+
+    std::atomic<int> foreground{0};
+
+    std::mutex mtx; // Guards everything below
+    std::condition_variable wake;
+    std::deque<SearchRequest> pending;
+    std::unordered_set<std::string> pending_keys;
+    uint64_t n_queued = 0, n_run = 0, n_skipped = 0, n_dropped = 0, n_preempted = 0;
+    bool stopping = false;
+    CancelToken shutdown;           // Cuts short the search in flight when stopping
+    CancelToken* running = nullptr; // The speculative search in flight, if any
+
+    std::thread worker;
+};
+
+#endif
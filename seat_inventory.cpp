@@ -0,0 +1,73 @@
+#include "seat_inventory.h"
+#include <mutex>
+
+using namespace std;
+
+atomic<int>* SeatInventory::counter(const string& flight_id) const {
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = counters.find(flight_id);
+    return it == counters.end() ? nullptr : it->second.get();
+}
+
+atomic<int>* SeatInventory::ensure(const string& flight_id, int available) {
+    unique_lock<shared_mutex> lock(mtx);
+    auto& slot = counters[flight_id];
+    if (!slot) slot = make_shared<atomic<int>>(available);
+    return slot.get();
+}
+
+void SeatInventory::erase(const string& flight_id) {
+    unique_lock<shared_mutex> lock(mtx);
+    counters.erase(flight_id);
+}
+
+void SeatInventory::adjust(const string& flight_id, int delta) {
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = counters.find(flight_id);
+    if (it != counters.end()) it->second->fetch_add(delta);
+}
+
+int SeatInventory::available(const string& flight_id) const {
+    shared_lock<shared_mutex> lock(mtx);
+    auto it = counters.find(flight_id);
+    return it == counters.end() ? -1 : it->second->load();
+}
+
+SeatInventory::Result SeatInventory::reserve(const vector<string>& flight_ids, int seats, string* failed_id) {
+    // Pin the counters first; the map lock is not held while we CAS
+    vector<shared_ptr<atomic<int>>> pinned;
+    {
+        shared_lock<shared_mutex> lock(mtx);
+        for (const auto& id : flight_ids) {
+            auto it = counters.find(id);
+            if (it == counters.end()) {
+                if (failed_id) *failed_id = id;
+                return Result::UNKNOWN_FLIGHT;
+            }
+            pinned.push_back(it->second);
+        }
+    }
+
+    for (size_t i = 0; i < pinned.size(); ++i) {
+        int cur = pinned[i]->load();
+        bool taken = false;
+        while (cur >= seats) {
+            if (pinned[i]->compare_exchange_weak(cur, cur - seats)) { taken = true; break; }
+        }
+        if (!taken) {
+            // Give back what we already took on the earlier legs
+            for (size_t j = 0; j < i; ++j) pinned[j]->fetch_add(seats);
+            if (failed_id) *failed_id = flight_ids[i];
+            return Result::SOLD_OUT;
+        }
+    }
+    return Result::OK;
+}
+
+void SeatInventory::release(const vector<string>& flight_ids, int seats) {
+    shared_lock<shared_mutex> lock(mtx);
+    for (const auto& id : flight_ids) {
+        auto it = counters.find(id);
+        if (it != counters.end()) it->second->fetch_add(seats);
+    }
+}
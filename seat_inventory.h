@@ -0,0 +1,40 @@
+#ifndef SEAT_INVENTORY_H
+#define SEAT_INVENTORY_H
+
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Remaining seats per flight, one atomic counter each. Reservations change
+// counters with compare-and-swap only; the shared_mutex guards the map shape
+// (flights added/removed), so concurrent bookings never block each other
+// and never touch JsonDB::db_mutex.
+class SeatInventory {
+public:
+    // Counter for a flight, or nullptr if it has none. Stays valid until
+    // erase() for that flight.
+    std::atomic<int>* counter(const std::string& flight_id) const;
+
+    // Creates the counter if missing (existing counts are kept)
+    std::atomic<int>* ensure(const std::string& flight_id, int available);
+    void erase(const std::string& flight_id);
+    void adjust(const std::string& flight_id, int delta); // e.g. capacity change
+
+    int available(const std::string& flight_id) const; // -1 if unknown
+
+    enum class Result { OK, UNKNOWN_FLIGHT, SOLD_OUT };
+
+    // All-or-nothing: takes `seats` on every flight, or on none of them.
+    // On failure `failed_id` names the flight that could not be served.
+    Result reserve(const std::vector<std::string>& flight_ids, int seats, std::string* failed_id = nullptr);
+    void release(const std::vector<std::string>& flight_ids, int seats);
+
+private:
+    mutable std::shared_mutex mtx;
+    std::unordered_map<std::string, std::shared_ptr<std::atomic<int>>> counters;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "socket_listener.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+SocketListener::SocketListener(Serve s, size_t max_conn, Reject r)
+    : serve(move(s)), reject(move(r)), max_connections(max_conn) {}
+
+SocketListener::~SocketListener() {
+    stop();
+}
+
+bool SocketListener::listen_unix(const string& path, string& error) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) { error = "Socket path empty or too long"; return false; }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // A socket file left behind by an earlier run would make bind fail
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) { error = path + " exists and is not a socket"; return false; }
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) { error = strerror(errno); return false; }
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        error = strerror(errno);
+        close(fd);
+        return false;
+    }
+    chmod(path.c_str(), 0660); // Owner and group (the co-located services) only
+    unix_path = path;
+    return start(fd, error);
+}
+
+bool SocketListener::listen_tcp(const string& host, int port, string& error) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) { error = "Invalid address " + host; return false; }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) { error = strerror(errno); return false; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        error = strerror(errno);
+        close(fd);
+        return false;
+    }
+    return start(fd, error);
+}
+
+bool SocketListener::start(int fd, string& error) {
+    if (listen(fd, 128) < 0) {
+        error = strerror(errno);
+        close(fd);
+        return false;
+    }
+    listen_fd = fd;
+    running = true;
+    acceptor = thread(&SocketListener::accept_loop, this);
+    return true;
+}
+
+void SocketListener::stop() {
+    if (!running.exchange(false)) return;
+    shutdown(listen_fd, SHUT_RDWR); // Wakes accept()
+    acceptor.join();
+    close(listen_fd);
+    listen_fd = -1;
+
+    lock_guard<mutex> lock(mtx);
+    for (auto& c : connections) shutdown(c->fd, SHUT_RDWR); // Wakes recv()
+    reap(true);
+    if (!unix_path.empty()) unlink(unix_path.c_str());
+}
+
+void SocketListener::reap(bool all) {
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (all || (*it)->done) {
+            (*it)->worker.join();
+            close((*it)->fd); // Closed only here, so stop() never shuts down a reused fd
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SocketListener::accept_loop() {
+    while (running) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (running) cerr << "[WARN] accept: " << strerror(errno) << endl;
+            break;
+        }
+        if (unix_path.empty()) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        }
+
+        lock_guard<mutex> lock(mtx);
+        reap(false);
+        if (connections.size() >= max_connections) {
+            if (reject) reject(fd);
+            close(fd);
+            continue;
+        }
+        connections.emplace_back(new Connection());
+        Connection* conn = connections.back().get();
+        conn->fd = fd;
+        conn->worker = thread([this, conn] {
+            serve(conn->fd);
+            conn->done = true;
+        });
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef SOCKET_LISTENER_H
+#define SOCKET_LISTENER_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Accepts stream connections on a Unix socket or a TCP port and serves each
+// one on its own thread. Shared by the HTTP Unix socket listener and the
+// binary protocol server; the protocol lives in the serve callback. POSIX only.
+class SocketListener {
+public:
+    // Runs a connection until the peer is done (or stop() shuts the fd
+    // down under it). Must not close fd.
+    typedef std::function<void(int fd)> Serve;
+    // Answers a connection over max_connections before it is closed
+    typedef std::function<void(int fd)> Reject;
+
+    SocketListener(Serve serve, size_t max_connections = 64, Reject reject = nullptr);
+    ~SocketListener(); // stop()
+
+    // Replaces a stale socket file at path; the socket is created mode 0660
+    bool listen_unix(const std::string& path, std::string& error);
+    bool listen_tcp(const std::string& host, int port, std::string& error);
+
+    // Closes the listener and every open connection and waits for their
+    // threads; removes the socket file of listen_unix
+    void stop();
+
+private:
+    struct Connection {
+        int fd;
+        std::thread worker;
+        std::atomic<bool> done{false};
+    };
+
+    bool start(int fd, std::string& error);
+    void accept_loop();
+    void reap(bool all); // Joins finished connections (or all of them); caller holds mtx
+
+    const Serve serve;
+    const Reject reject;
+    const size_t max_connections;
+
+    std::string unix_path;
+    int listen_fd = -1;
+    std::atomic<bool> running{false};
+    std::thread acceptor;
+
+    std::mutex mtx; // Guards connections
+    std::list<std::unique_ptr<Connection>> connections;
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "standing_queries.h"
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+StandingQueries::StandingQueries(JsonDB& database, size_t max_q) : db(database), max_queries(max_q) {
+    worker = thread(&StandingQueries::run, this);
+}
+
+StandingQueries::~StandingQueries() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    shutdown.cancel();
+    wake.notify_all();
+    worker.join();
+}
+
+// ==========================================
+// REGISTRY
+// ==========================================
+
+string StandingQueries::add(const SearchRequest& r, json* routes) {
+    {
+        lock_guard<mutex> lock(mtx);
+        if (queries.size() >= max_queries) return "";
+    }
+
+    uint64_t version = db.version(r.date);
+    json result = run_search(db, r);
+    Query q;
+    q.request = r;
+    summarize(q, result);
+    if (routes) *routes = result;
+    bool stale = db.version(r.date) != version; // An admin op or status batch ran during the search
+
+    static thread_local mt19937 rng(random_device{}());
+    ostringstream id;
+    {
+        lock_guard<mutex> lock(mtx);
+        id << "SQ" << next_query++ << "-" << hex << rng();
+        if (stale) changes.push_back({r.srcs, {}});
+        queries[id.str()] = move(q);
+    }
+    if (stale) wake.notify_all();
+    return id.str();
+}
+
+bool StandingQueries::remove(const string& id) {
+    lock_guard<mutex> lock(mtx);
+    auto it = queries.find(id);
+    if (it == queries.end()) return false;
+    for (SubscriberId sub : it->second.subscribers) sinks.erase(sub);
+    queries.erase(it);
+    return true;
+}
+
+bool StandingQueries::current(const string& id, json& routes) {
+    lock_guard<mutex> lock(mtx);
+    auto it = queries.find(id);
+    if (it == queries.end()) return false;
+    routes = json::parse(it->second.body);
+    return true;
+}
+
+StandingQueries::SubscriberId StandingQueries::subscribe(const string& id, Sink sink) {
+    lock_guard<mutex> lock(mtx);
+    auto it = queries.find(id);
+    if (it == queries.end()) return 0;
+    SubscriberId sub = next_subscriber++;
+    it->second.subscribers.push_back(sub);
+    sinks[sub] = {id, move(sink)};
+    return sub;
+}
+
+void StandingQueries::unsubscribe(SubscriberId sub) {
+    lock_guard<mutex> lock(mtx);
+    auto s = sinks.find(sub);
+    if (s == sinks.end()) return;
+    auto q = queries.find(s->second.first);
+    if (q != queries.end()) {
+        auto& subs = q->second.subscribers;
+        for (size_t i = 0; i < subs.size(); ++i) {
+            if (subs[i] == sub) { subs[i] = subs.back(); subs.pop_back(); break; }
+        }
+    }
+    sinks.erase(s);
+}
+
+StandingQueries::Stats StandingQueries::stats() {
+    lock_guard<mutex> lock(mtx);
+    return {queries.size(), n_changes, n_evaluated, n_skipped, n_notified};
+}
+
+// ==========================================
+// RELEVANCE
+// ==========================================
+
+void StandingQueries::summarize(Query& q, const json& routes) {
+    q.body = routes.dump();
+    q.airports.clear();
+    q.flights.clear();
+    q.airports.insert(q.request.srcs.begin(), q.request.srcs.end());
+    q.airports.insert(q.request.dsts.begin(), q.request.dsts.end());
+    for (const auto& route : routes) {
+        for (const auto& seg : route["segments"]) {
+            q.airports.insert(seg["from"].get<string>());
+            q.airports.insert(seg["to"].get<string>());
+            q.flights.insert(seg["flight_id"].get<string>());
+        }
+    }
+    q.kth_minutes = (int)routes.size() >= q.request.k ? routes.back()["total_time"].get<int>() : -1;
+}
+
+bool StandingQueries::affected(const Query& q, const ScheduleChange& change) {
+    for (const auto& code : change.airports) {
+        if (q.airports.count(code)) return true;
+    }
+
+    const SearchConstraints& c = q.request.constraints;
+    for (const auto& f : change.flights) {
+        if (f.date != q.request.date) continue;
+        if (q.flights.count(f.id)) return true; // Edited or removed a result leg
+
+        // Could a route through this flight make the top K?
+        if (c.max_price >= 0 && f.price > c.max_price) continue;
+        if (!c.airlines.empty() && find(c.airlines.begin(), c.airlines.end(), f.airline) == c.airlines.end()) continue;
+        if (find(c.avoid.begin(), c.avoid.end(), f.from) != c.avoid.end() ||
+            find(c.avoid.begin(), c.avoid.end(), f.to) != c.avoid.end()) continue;
+        if (q.kth_minutes >= 0 && f.minutes > q.kth_minutes) continue;
+        return true;
+    }
+    return false;
+}
+
+// ==========================================
+// RE-EVALUATION
+// ==========================================
+
+void StandingQueries::on_change(const ScheduleChange& change) {
+    {
+        lock_guard<mutex> lock(mtx);
+        if (queries.empty()) return;
+        changes.push_back(change);
+        n_changes++;
+    }
+    wake.notify_all();
+}
+
+void StandingQueries::run() {
+    unique_lock<mutex> lock(mtx);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || !changes.empty(); });
+        if (stopping) break;
+
+        deque<ScheduleChange> batch;
+        batch.swap(changes);
+
+        vector<pair<string, SearchRequest>> todo;
+        for (const auto& entry : queries) {
+            bool hit = false;
+            for (const auto& change : batch) {
+                if ((hit = affected(entry.second, change))) break;
+            }
+            if (hit) todo.push_back({entry.first, entry.second.request});
+            else n_skipped++;
+        }
+        lock.unlock();
+
+        vector<json> results;
+        for (const auto& t : todo) {
+            SearchStats stats;
+            results.push_back(run_search(db, t.second, &stats, nullptr, &shutdown));
+            if (stats.cancelled) return; // Stopping; drop the partial batch
+        }
+
+        lock.lock();
+        for (size_t i = 0; i < todo.size(); ++i) {
+            n_evaluated++;
+            auto it = queries.find(todo[i].first);
+            if (it == queries.end()) continue; // Removed meanwhile
+            Query& q = it->second;
+            string body = results[i].dump();
+            if (body == q.body) continue;
+
+            summarize(q, results[i]);
+            string message = json{{"query", it->first}, {"routes", results[i]}}.dump();
+            for (SubscriberId sub : q.subscribers) {
+                auto s = sinks.find(sub);
+                if (s != sinks.end()) { s->second.second(message); n_notified++; }
+            }
+        }
+    }
+}
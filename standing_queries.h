@@ -0,0 +1,85 @@
+#ifndef STANDING_QUERIES_H
+#define STANDING_QUERIES_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "search_cache.h"
+
+// Saved searches that are kept up to date instead of polled. Admin ops
+// reach on_change() (via JsonDB's change listener); a background thread
+// then re-runs only the queries the change could affect and pushes the new
+// top K to every subscriber whose result actually changed.
+//
+// A change can affect a query when it touches one of its endpoint or
+// result airports, edits or removes a flight of its current result, or
+// adds a flight on its date that passes its constraints and is not slower
+// on its own than the K-th route the query already has.
+class StandingQueries {
+public:
+    explicit StandingQueries(JsonDB& db, size_t max_queries = 1000);
+    ~StandingQueries(); // Stops the re-evaluation thread
+
+    // Registers a query and runs it once; empty id when the registry is full
+    std::string add(const SearchRequest& r, json* routes = nullptr);
+    bool remove(const std::string& id);
+    bool current(const std::string& id, json& routes); // Last evaluated result
+
+    // Receives {"query": id, "routes": [...]} messages
+    typedef std::function<void(const std::string&)> Sink;
+    typedef uint64_t SubscriberId;
+
+    // Subscribes to one query; 0 if it does not exist. The sink is only
+    // called while subscribed, so it may reference a connection that is
+    // unsubscribed when it closes.
+    SubscriberId subscribe(const std::string& id, Sink sink);
+    void unsubscribe(SubscriberId sub);
+
+    // Queues a change for re-evaluation (cheap; safe under db_mutex)
+    void on_change(const ScheduleChange& change);
+
+    struct Stats {
+        size_t queries;
+        uint64_t changes, evaluated, skipped, notified;
+    };
+    Stats stats();
+
+private:
+    struct Query {
+        SearchRequest request;
+        std::string body;                          // Serialized routes
+        std::unordered_set<std::string> airports;  // Endpoints and result airports
+        std::unordered_set<std::string> flights;   // Result flight ids
+        int kth_minutes;                           // Cost of the K-th route (-1 if fewer than K)
+        std::vector<SubscriberId> subscribers;
+    };
+
+    static void summarize(Query& q, const json& routes);
+    static bool affected(const Query& q, const ScheduleChange& change);
+    void run();
+
+    JsonDB& db;
+    const size_t max_queries;
+
+    std::mutex mtx; // Guards everything below
+    std::map<std::string, Query> queries;
+    std::unordered_map<SubscriberId, std::pair<std::string, Sink>> sinks;
+    uint64_t next_query = 1, next_subscriber = 1;
+    std::deque<ScheduleChange> changes;
+    uint64_t n_changes = 0, n_evaluated = 0, n_skipped = 0, n_notified = 0;
+    bool stopping = false;
+    std::condition_variable wake;
+    CancelToken shutdown; // Cuts short a re-evaluation in flight when stopping
+
+    std::thread worker;
+};
+
+#endif
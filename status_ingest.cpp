@@ -0,0 +1,99 @@
+#include "status_ingest.h"
+#include <algorithm>
+
+using namespace std;
+
+static const size_t MAX_REPORTED_ERRORS = 20;
+
+bool parse_status_event(const string& line, FlightStatusEvent& out, string& error) {
+    auto j = json::parse(line, nullptr, false);
+    if (!j.is_object()) { error = "Not a JSON object"; return false; }
+    if (!j.contains("id") || !j["id"].is_string()) { error = "Missing id"; return false; }
+    out = FlightStatusEvent();
+    out.id = j["id"];
+
+    if (j.contains("delay_minutes")) {
+        if (!j["delay_minutes"].is_number_integer() || j["delay_minutes"].get<int>() < 0) {
+            error = "delay_minutes must be a non-negative integer";
+            return false;
+        }
+        out.delay_minutes = j["delay_minutes"];
+    }
+    if (j.contains("status")) {
+        string status = j["status"].is_string() ? j["status"].get<string>() : "";
+        if (status == "cancelled") {
+            out.cancelled = 1;
+        } else if (status == "scheduled") {
+            out.cancelled = 0;
+        } else if (status == "on_time") {
+            out.cancelled = 0;
+            if (out.delay_minutes < 0) out.delay_minutes = 0;
+        } else if (status == "delayed") {
+            out.cancelled = 0;
+            if (out.delay_minutes < 0) { error = "delayed needs delay_minutes"; return false; }
+        } else {
+            error = "Unknown status";
+            return false;
+        }
+    }
+    if (out.delay_minutes < 0 && out.cancelled < 0) { error = "Nothing to apply"; return false; }
+    return true;
+}
+
+StatusIngest::StatusIngest(JsonDB& database, size_t batch)
+    : db(database), batch_size(batch ? batch : 1) {}
+
+StatusIngest::Report StatusIngest::ingest(const string& ndjson) {
+    Report report;
+    auto reject = [&](size_t line_no, const string& error) {
+        report.rejected++;
+        if (report.errors.size() < MAX_REPORTED_ERRORS) report.errors.push_back({{"line", line_no}, {"error", error}});
+    };
+
+    vector<FlightStatusEvent> batch;
+    vector<size_t> batch_lines;
+    vector<string> errors;
+    auto flush = [&] {
+        if (batch.empty()) return;
+        report.applied += db.apply_status(batch, errors);
+        n_batches++;
+        for (size_t i = 0; i < errors.size(); ++i) {
+            if (!errors[i].empty()) reject(batch_lines[i], errors[i]);
+        }
+        batch.clear();
+        batch_lines.clear();
+    };
+
+    size_t line_no = 0;
+    for (size_t pos = 0; pos < ndjson.size();) {
+        size_t end = ndjson.find('\n', pos);
+        if (end == string::npos) end = ndjson.size();
+        string line = ndjson.substr(pos, end - pos);
+        pos = end + 1;
+        line_no++;
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+
+        FlightStatusEvent ev;
+        string error;
+        if (!parse_status_event(line, ev, error)) {
+            reject(line_no, error);
+            continue;
+        }
+        batch.push_back(move(ev));
+        batch_lines.push_back(line_no);
+        if (batch.size() >= batch_size) flush();
+    }
+    flush();
+    // Failed applies are reported after parse errors further down the feed
+    sort(report.errors.begin(), report.errors.end(),
+         [](const json& a, const json& b) { return a["line"].get<size_t>() < b["line"].get<size_t>(); });
+
+    n_events += report.applied + report.rejected;
+    n_applied += report.applied;
+    n_rejected += report.rejected;
+    return report;
+}
+
+StatusIngest::Stats StatusIngest::stats() const {
+    return {n_events.load(), n_applied.load(), n_rejected.load(), n_batches.load()};
+}
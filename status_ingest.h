@@ -0,0 +1,42 @@
+#ifndef STATUS_INGEST_H
+#define STATUS_INGEST_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "jsondb.h"
+
+// Flight status feed: NDJSON, one event per line, e.g.
+//   {"id": "FL1001", "delay_minutes": 45}
+//   {"id": "FL1001", "status": "on_time"}      (delay back to 0)
+//   {"id": "FL1002", "status": "cancelled"}
+//   {"id": "FL1002", "status": "scheduled"}    (reinstated)
+// Lines are parsed outside db_mutex and applied batch_size at a time with
+// JsonDB::apply_status, so a big feed takes the lock briefly and often
+// instead of once for its whole length, and searches keep flowing.
+class StatusIngest {
+public:
+    explicit StatusIngest(JsonDB& db, size_t batch_size = 64);
+
+    struct Report {
+        size_t applied = 0, rejected = 0;
+        json errors = json::array(); // First few {line, error}, lines from 1
+    };
+    Report ingest(const std::string& ndjson);
+
+    struct Stats {
+        uint64_t events, applied, rejected, batches;
+    };
+    Stats stats() const;
+
+private:
+    JsonDB& db;
+    const size_t batch_size;
+    std::atomic<uint64_t> n_events{0}, n_applied{0}, n_rejected{0}, n_batches{0};
+};
+
+// Reads one feed line into an event; false with `error` set if malformed
+bool parse_status_event(const std::string& line, FlightStatusEvent& out, std::string& error);
+
+#endif
@@ -0,0 +1,83 @@
+#include "suggest_index.h"
+#include <cctype>
+#include <mutex>
+
+using namespace std;
+
+string AirportSuggestIndex::fold(const string& text) {
+    // Lower-case, and collapse anything that is not a letter or digit into a
+    // single space so "Chhatrapati-Shivaji" and "chhatrapati shivaji" agree
+    string out;
+    for (unsigned char ch : text) {
+        if (isalnum(ch) || ch >= 0x80) {
+            out += (char)tolower(ch);
+        } else if (!out.empty() && out.back() != ' ') {
+            out += ' ';
+        }
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+void AirportSuggestIndex::clear() {
+    unique_lock<shared_mutex> lock(mtx);
+    for (auto& k : keys) k.clear();
+    airports.clear();
+    owned_keys.clear();
+}
+
+void AirportSuggestIndex::insert_key(int field, const string& key, const string& code) {
+    if (key.empty()) return;
+    keys[field].insert({key, code});
+    owned_keys[code].push_back({field, key});
+}
+
+void AirportSuggestIndex::add(const json& airport) {
+    string code = airport.value("code", "");
+    if (code.empty()) return;
+
+    unique_lock<shared_mutex> lock(mtx);
+    airports[code] = airport;
+
+    insert_key(CODE, fold(code), code);
+
+    // Index every word start of the city and the name
+    const pair<Field, string> texts[] = {
+        {CITY, fold(airport.value("city", ""))},
+        {NAME, fold(airport.value("name", ""))}
+    };
+    for (const auto& t : texts) {
+        const string& folded = t.second;
+        for (size_t i = 0; i < folded.size(); ++i) {
+            if (i == 0 || folded[i - 1] == ' ') insert_key(t.first, folded.substr(i), code);
+        }
+    }
+}
+
+void AirportSuggestIndex::remove(const string& code) {
+    unique_lock<shared_mutex> lock(mtx);
+    auto it = owned_keys.find(code);
+    if (it != owned_keys.end()) {
+        for (const auto& fk : it->second) keys[fk.first].erase({fk.second, code});
+        owned_keys.erase(it);
+    }
+    airports.erase(code);
+}
+
+json AirportSuggestIndex::suggest(const string& query, size_t limit) const {
+    json res = json::array();
+    string q = fold(query);
+    if (q.empty() || limit == 0) return res;
+
+    shared_lock<shared_mutex> lock(mtx);
+    set<string> seen;
+    for (int field = 0; field < FIELD_COUNT && res.size() < limit; ++field) {
+        for (auto it = keys[field].lower_bound({q, ""}); it != keys[field].end(); ++it) {
+            if (it->first.compare(0, q.size(), q) != 0) break;
+            if (!seen.insert(it->second).second) continue;
+            res.push_back(airports.at(it->second));
+            if (res.size() >= limit) break;
+        }
+    }
+    return res;
+}
@@ -0,0 +1,45 @@
+#ifndef SUGGEST_INDEX_H
+#define SUGGEST_INDEX_H
+
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Sorted prefix index over airport code, city and name for autocomplete.
+// Keys are case-folded; every word of a city or name is indexed as its own
+// suffix ("indira gandhi intl", "gandhi intl", "intl") so any word prefix
+// matches. Updates are incremental and the index has its own reader/writer
+// lock, so lookups never wait behind a running route search.
+class AirportSuggestIndex {
+public:
+    void clear();
+    void add(const json& airport);          // Expects "code", "city", "name"
+    void remove(const std::string& code);
+
+    // Airports whose code, city or a word of their name starts with `query`:
+    // code matches first, then city, then name; alphabetical within each.
+    json suggest(const std::string& query, size_t limit) const;
+
+    static std::string fold(const std::string& text);
+
+private:
+    enum Field { CODE = 0, CITY = 1, NAME = 2, FIELD_COUNT = 3 };
+
+    // (folded key, airport code), one ordered set per field
+    std::set<std::pair<std::string, std::string>> keys[FIELD_COUNT];
+
+    // Code -> stored airport, and the keys it owns (for removal)
+    std::unordered_map<std::string, json> airports;
+    std::unordered_map<std::string, std::vector<std::pair<int, std::string>>> owned_keys;
+
+    mutable std::shared_mutex mtx;
+
+    void insert_key(int field, const std::string& key, const std::string& code);
+};
+
+#endif
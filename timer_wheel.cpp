@@ -0,0 +1,126 @@
+#include "timer_wheel.h"
+
+using namespace std;
+
+TimerWheel::TimerWheel(uint64_t start_tick) : current(start_tick) {
+    for (auto& level : heads) {
+        for (auto& head : level) head = -1;
+    }
+}
+
+// ==========================================
+// SLOT LISTS
+// ==========================================
+
+void TimerWheel::link(int idx) {
+    Node& n = nodes[idx];
+
+    // expire >= current here: schedule() clamps, and cascading runs before
+    // the current tick's slot is fired, so expire == current still fires now
+    uint64_t expire = n.expire;
+    uint64_t delta = expire - current;
+
+    // The finest level whose span covers the delay; within it the slot is
+    // picked from the absolute expiry bits, so it lines up with cascading
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ull << (BITS * (level + 1)))) level++;
+    int slot = (int)((expire >> (BITS * level)) & (SLOTS - 1));
+
+    n.level = level;
+    n.slot = slot;
+    n.prev = -1;
+    n.next = heads[level][slot];
+    if (n.next != -1) nodes[n.next].prev = idx;
+    heads[level][slot] = idx;
+}
+
+void TimerWheel::unlink(int idx) {
+    Node& n = nodes[idx];
+    if (n.prev != -1) nodes[n.prev].next = n.next;
+    else heads[n.level][n.slot] = n.next;
+    if (n.next != -1) nodes[n.next].prev = n.prev;
+    n.prev = n.next = -1;
+}
+
+void TimerWheel::release(int idx) {
+    nodes[idx].level = nodes[idx].slot = -1;
+    nodes[idx].generation++;
+    free_nodes.push_back(idx);
+    active--;
+}
+
+// ==========================================
+// PUBLIC API
+// ==========================================
+
+TimerWheel::TimerId TimerWheel::schedule(uint64_t expire_tick, uint64_t payload) {
+    // Overdue timers go in the next tick's slot
+    if (expire_tick <= current) expire_tick = current + 1;
+    if (expire_tick > current + MAX_DELAY) expire_tick = current + MAX_DELAY;
+
+    int idx;
+    if (!free_nodes.empty()) {
+        idx = free_nodes.back();
+        free_nodes.pop_back();
+    } else {
+        idx = (int)nodes.size();
+        nodes.push_back({0, 0, -1, -1, -1, -1, 1});
+    }
+    nodes[idx].expire = expire_tick;
+    nodes[idx].payload = payload;
+    link(idx);
+    active++;
+
+    // Handle = generation in the high half, node index + 1 in the low half
+    return ((uint64_t)nodes[idx].generation << 32) | (uint64_t)(idx + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    int idx = (int)(id & 0xffffffffu) - 1;
+    uint32_t generation = (uint32_t)(id >> 32);
+    if (idx < 0 || idx >= (int)nodes.size()) return false;
+    if (nodes[idx].generation != generation || nodes[idx].level == -1) return false;
+    unlink(idx);
+    release(idx);
+    return true;
+}
+
+void TimerWheel::cascade(int level, int slot) {
+    // Detach the whole list first: re-linking may target this same slot
+    int idx = heads[level][slot];
+    heads[level][slot] = -1;
+    while (idx != -1) {
+        int next = nodes[idx].next;
+        link(idx);
+        idx = next;
+    }
+}
+
+void TimerWheel::advance(uint64_t now_tick, vector<uint64_t>& expired) {
+    while (current < now_tick) {
+        current++;
+
+        int slot0 = (int)(current & (SLOTS - 1));
+        if (slot0 == 0) {
+            // Level 0 wrapped: pull the next block of coarser timers down
+            for (int level = 1; level < LEVELS; ++level) {
+                int slot = (int)((current >> (BITS * level)) & (SLOTS - 1));
+                cascade(level, slot);
+                if (slot != 0) break;
+            }
+        }
+
+        // Everything left in this slot is due now
+        int idx = heads[0][slot0];
+        heads[0][slot0] = -1;
+        while (idx != -1) {
+            int next = nodes[idx].next;
+            expired.push_back(nodes[idx].payload);
+            release(idx);
+            idx = next;
+        }
+
+        // Idle wheel: jump straight to the target
+        if (active == 0) current = now_tick;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel (4 levels x 64 slots). Time is measured in
+// ticks chosen by the caller. schedule() and cancel() are O(1): timers are
+// nodes of intrusive doubly-linked slot lists, addressed by a handle that
+// carries a generation so stale handles are harmless. advance() fires a
+// whole slot per tick and cascades the coarser levels as the finer ones
+// wrap. Not thread-safe; the owner serialises access.
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;
+    static const TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(uint64_t start_tick = 0);
+
+    // Fires at the first advance() that reaches expire_tick (past ticks fire
+    // on the next advance). Delays beyond the wheel's range are clamped.
+    TimerId schedule(uint64_t expire_tick, uint64_t payload);
+    bool cancel(TimerId id);
+
+    // Moves time forward to now_tick, appending the payloads of every timer
+    // that expired on the way
+    void advance(uint64_t now_tick, std::vector<uint64_t>& expired);
+
+    uint64_t now() const { return current; }
+    size_t size() const { return active; }
+
+private:
+    static const int LEVELS = 4;
+    static const int BITS = 6;
+    static const int SLOTS = 1 << BITS;
+    static const uint64_t MAX_DELAY = (1ull << (BITS * LEVELS)) - 1;
+
+    struct Node {
+        uint64_t expire;
+        uint64_t payload;
+        int prev, next;      // Slot list links (-1 = none)
+        int level, slot;     // Where the node currently lives (-1 = free)
+        uint32_t generation;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> free_nodes;
+    int heads[LEVELS][SLOTS];
+    uint64_t current;
+    size_t active = 0;
+
+    void link(int idx);
+    void unlink(int idx);
+    void release(int idx);
+    void cascade(int level, int slot);
+};
+
+#endif
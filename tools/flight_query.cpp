@@ -0,0 +1,166 @@
+// ==========================================
+// BATCH QUERY TOOL
+// ==========================================
+// Loads a database snapshot as the server does and runs a file of
+// /api/search queries against it on every core, then prints throughput
+// and latency per pass: a capacity estimate without the HTTP layer or the
+// response cache.
+//
+// The query file holds one /api/search query string per line, the format
+// of popular_searches.txt ("from=DEL&to=BOM&date=2025-12-01&mode=fast").
+// Blank lines and lines starting with '#' are skipped. Each pass runs
+// every query once; later passes find the continuation memo warm, as a
+// long-running server would.
+//
+// Searches share one store and its lock, as in the server. --replicas
+// loads one store per thread instead, to show what the engine sustains
+// when the lock is not the limit. The snapshot (and its status journal) is
+// copied to a temporary directory first, so a live server's files are
+// never touched.
+//
+// Usage: flight_query <snapshot.json> <queries.txt> [--threads N] [--passes N] [--replicas]
+
+#include "jsondb.h"
+#include "metrics.h"
+#include "search_cache.h"
+#include "search_params.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using query_clock = chrono::steady_clock;
+
+struct PassResult {
+    double wall_ms = 0;
+    LatencyHistogram latency;
+    atomic<uint64_t> labels{0}, routes{0}, cancelled{0};
+};
+
+// Runs every request once across `threads` workers; worker t searches stores[t % stores.size()]
+static void run_pass(const vector<SearchRequest>& requests, vector<unique_ptr<JsonDB>>& stores, unsigned threads,
+                     PassResult& out) {
+    atomic<size_t> next{0};
+    auto start = query_clock::now();
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            JsonDB& db = *stores[t % stores.size()];
+            for (size_t i; (i = next.fetch_add(1)) < requests.size();) {
+                const SearchRequest& r = requests[i];
+                CancelToken cancel;
+                if (r.timeout_ms > 0) cancel.set_timeout(chrono::milliseconds(r.timeout_ms));
+                SearchStats stats;
+                auto t0 = query_clock::now();
+                json routes = run_search(db, r, &stats, nullptr, &cancel);
+                out.latency.record_ms(chrono::duration<double, milli>(query_clock::now() - t0).count());
+                out.labels.fetch_add(stats.pushed, memory_order_relaxed);
+                out.routes.fetch_add(routes.size(), memory_order_relaxed);
+                if (stats.cancelled) out.cancelled.fetch_add(1, memory_order_relaxed);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    out.wall_ms = chrono::duration<double, milli>(query_clock::now() - start).count();
+}
+
+static void usage() {
+    cerr << "Usage: flight_query <snapshot.json> <queries.txt> [--threads N] [--passes N] [--replicas]" << endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 1;
+    }
+    string snapshot = argv[1], query_file = argv[2];
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    int passes = 3;
+    bool replicas = false;
+    for (int i = 3; i < argc; ++i) {
+        string arg = argv[i];
+        try {
+            if (arg == "--threads" && i + 1 < argc) threads = (unsigned)max(1, stoi(argv[++i]));
+            else if (arg == "--passes" && i + 1 < argc) passes = max(1, stoi(argv[++i]));
+            else if (arg == "--replicas") replicas = true;
+            else { usage(); return 1; }
+        } catch (...) {
+            usage();
+            return 1;
+        }
+    }
+
+    // A missing file would make JsonDB seed a fresh database instead
+    error_code ec;
+    if (!filesystem::is_regular_file(snapshot, ec)) {
+        cerr << "[ERROR] No snapshot at " << snapshot << endl;
+        return 1;
+    }
+    ifstream in(query_file);
+    if (!in) {
+        cerr << "[ERROR] Cannot read " << query_file << endl;
+        return 1;
+    }
+
+    filesystem::path work = filesystem::temp_directory_path() / ("flight_query_" + to_string(query_clock::now().time_since_epoch().count()));
+    filesystem::create_directories(work);
+    string copy = (work / "snapshot.json").string();
+    filesystem::copy_file(snapshot, copy);
+    if (filesystem::exists(snapshot + ".status", ec)) filesystem::copy_file(snapshot + ".status", copy + ".status");
+
+    int exit_code = 0;
+    {
+        auto t0 = query_clock::now();
+        vector<unique_ptr<JsonDB>> stores;
+        for (unsigned i = 0; i < (replicas ? threads : 1u); ++i) stores.emplace_back(new JsonDB(copy));
+        double load_ms = chrono::duration<double, milli>(query_clock::now() - t0).count();
+
+        vector<SearchRequest> requests;
+        string line, error;
+        size_t line_no = 0, skipped = 0;
+        while (getline(in, line)) {
+            line_no++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            QueryParams params(line);
+            SearchRequest r;
+            if (parse_search_params(*stores[0], params.lookup(), r, error)) {
+                if (skipped++ < 5) cerr << "[WARN] line " << line_no << ": " << error << endl;
+                continue;
+            }
+            requests.push_back(r);
+        }
+
+        cout << fixed << setprecision(1);
+        cout << "[INFO] Loaded " << snapshot << " (" << stores[0]->get_all_airports().size() << " airports) "
+             << stores.size() << (stores.size() == 1 ? " time" : " times") << " in " << load_ms << " ms" << endl;
+        cout << "[INFO] " << requests.size() << " queries, " << skipped << " skipped; " << threads << " threads, "
+             << (replicas ? "one store per thread" : "one shared store") << endl;
+
+        if (requests.empty()) {
+            exit_code = 1;
+        } else {
+            cout << "pass   queries   wall_ms        qps   p50_ms   p90_ms   p99_ms   max_ms  avg_labels  avg_routes  timed_out\n";
+            for (int p = 1; p <= passes; ++p) {
+                PassResult res;
+                run_pass(requests, stores, threads, res);
+                json lat = res.latency.to_json();
+                double n = (double)requests.size();
+                cout << setw(4) << p << setw(10) << requests.size() << setw(10) << res.wall_ms << setw(11)
+                     << n / max(res.wall_ms, 0.001) * 1000 << setprecision(2) << setw(9) << lat["p50_ms"].get<double>()
+                     << setw(9) << lat["p90_ms"].get<double>() << setw(9) << lat["p99_ms"].get<double>() << setw(9)
+                     << lat["max_ms"].get<double>() << setprecision(1) << setw(12) << res.labels / n << setw(12)
+                     << res.routes / n << setw(11) << res.cancelled.load() << "\n";
+            }
+        }
+    }
+    filesystem::remove_all(work, ec);
+    return exit_code;
+}
@@ -0,0 +1,729 @@
+// ==========================================
+// SSIM SCHEDULE IMPORTER
+// ==========================================
+// Converts an SSIM-style schedule (IATA chapter 7, 200-byte records) into
+// the server's database file, offline. Each flight leg record (type 3)
+// has a period of operation, days of the week and an optional fortnightly
+// rate; it is expanded into one dated flight per operating day and/or kept
+// as one pattern line. The input is memory-mapped and cut at record
+// boundaries into chunks that are parsed and expanded in parallel. Other
+// record types are skipped.
+//
+// SSIM carries no fares or seat counts: prices come from a distance model
+// over the base database's airport coordinates, capacity is a flat value.
+//
+// Usage: ssim_import <schedule.ssim> [options]
+//   --db FILE            Write dated flights as a server database (JSON)
+//   --patterns FILE      Write one JSON line per leg, recurrence kept
+//   --base FILE          Airports (and with --keep-flights, flights) from this database
+//   --keep-flights       Keep the base flights; imported ids that clash are dropped
+//   --from DATE --to DATE  Only expand days in this window (YYYY-MM-DD)
+//   --airlines FILE      "CODE,Name" lines naming airline designators
+//   --fare-base N        Fare for a flight of 0 km (default 1500)
+//   --fare-per-km X      Added per great-circle km (default 4.5)
+//   --capacity N         Seats per flight (default 180)
+//   --threads N          Parser threads (default: all cores)
+//   --target N           Exit with status 3 below N records/s end to end
+
+#include "Models.h"
+#include "geoindex.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using json = nlohmann::json;
+using import_clock = chrono::steady_clock;
+
+static const size_t SSIM_RECORD = 200;
+static const size_t MIN_LEG_RECORD = 75;  // Through the aircraft type
+static const int INDEFINITE = -1000000;   // "00XXX00": no end date
+static const size_t MAX_ERRORS = 10;      // Kept per chunk for the report
+
+// ==========================================
+// INPUT
+// ==========================================
+
+// Read-only view of a whole file: mapped where the platform allows it,
+// otherwise read into memory
+class MappedFile {
+public:
+    ~MappedFile() {
+#ifndef _WIN32
+        if (map) munmap(map, len);
+#endif
+    }
+
+    bool open(const string& path) {
+#ifdef _WIN32
+        ifstream in(path, ios::binary);
+        if (!in) return false;
+        buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        ptr = buffer.data();
+        len = buffer.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        len = (size_t)st.st_size;
+        if (len > 0) {
+            map = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map == MAP_FAILED) map = nullptr;
+            else madvise(map, len, MADV_SEQUENTIAL);
+        }
+        close(fd);
+        ptr = map ? (const char*)map : "";
+        return map || len == 0;
+#endif
+    }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const char* ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    string buffer;
+#else
+    void* map = nullptr;
+#endif
+};
+
+// ==========================================
+// DATES
+// ==========================================
+// Days are counted from 1970-01-01 (proleptic Gregorian)
+
+static int days_from_civil(int y, int m, int d) {
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(int z, int& y, int& m, int& d) {
+    z += 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+static int weekday(int day) { return ((day % 7) + 10) % 7 + 1; } // 1 = Monday, as in SSIM
+
+static bool valid_date(int y, int m, int d, int& day) {
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    day = days_from_civil(y, m, d);
+    int y2, m2, d2;
+    civil_from_days(day, y2, m2, d2);
+    return m2 == m && d2 == d; // Rejects 31APR and friends
+}
+
+static bool is_digits(string_view s) {
+    return !s.empty() && all_of(s.begin(), s.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+static int to_int(string_view s) {
+    int v = 0;
+    for (char c : s) v = v * 10 + (c - '0');
+    return v;
+}
+
+// "01DEC25"; INDEFINITE for "00XXX00"
+static bool parse_ssim_date(string_view s, int& day) {
+    if (s == "00XXX00") {
+        day = INDEFINITE;
+        return true;
+    }
+    static const char* months = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+    if (!is_digits(s.substr(0, 2)) || !is_digits(s.substr(5, 2))) return false;
+    string_view mon = s.substr(2, 3);
+    for (int m = 0; m < 12; ++m) {
+        if (mon == string_view(months + 3 * m, 3)) {
+            return valid_date(2000 + to_int(s.substr(5, 2)), m + 1, to_int(s.substr(0, 2)), day);
+        }
+    }
+    return false;
+}
+
+// "2025-12-01"
+static bool parse_iso_date(const string& s, int& day) {
+    if (s.size() != 10 || s[4] != '-' || s[7] != '-') return false;
+    string_view v(s);
+    if (!is_digits(v.substr(0, 4)) || !is_digits(v.substr(5, 2)) || !is_digits(v.substr(8, 2))) return false;
+    return valid_date(to_int(v.substr(0, 4)), to_int(v.substr(5, 2)), to_int(v.substr(8, 2)), day);
+}
+
+static string iso_date(int day) {
+    int y, m, d;
+    civil_from_days(day, y, m, d);
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, d);
+    return buf;
+}
+
+// "0630" -> minutes after midnight
+static bool parse_hhmm(string_view s, int& minutes) {
+    if (!is_digits(s)) return false;
+    int h = to_int(s.substr(0, 2)), m = to_int(s.substr(2, 2));
+    if (h > 23 || m > 59) return false;
+    minutes = h * 60 + m;
+    return true;
+}
+
+// "+0530" -> minutes east of UTC
+static bool parse_utc_offset(string_view s, int& minutes) {
+    if ((s[0] != '+' && s[0] != '-') || !parse_hhmm(s.substr(1, 4), minutes)) return false;
+    if (s[0] == '-') minutes = -minutes;
+    return true;
+}
+
+static string hhmm(int minutes) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%02d:%02d", minutes / 60, minutes % 60);
+    return buf;
+}
+
+// ==========================================
+// LEG RECORDS
+// ==========================================
+
+struct Leg {
+    string airline, number, from, to, aircraft;
+    char suffix = ' ';
+    int variation = 1, seq = 1;
+    int first_day = 0, last_day = 0;  // Period of operation, inclusive
+    uint8_t days = 0;                 // Bit d-1 set when it operates on weekday d (1 = Monday)
+    int every_weeks = 1;              // 2 for a fortnightly rate, counted from the first day
+    int dep = 0, arr = 0, duration = 0; // Local minutes after midnight; block minutes
+    int price = 0;
+};
+
+static string_view trim(string_view s) {
+    while (!s.empty() && s.front() == ' ') s.remove_prefix(1);
+    while (!s.empty() && s.back() == ' ') s.remove_suffix(1);
+    return s;
+}
+
+static bool is_station(string_view s) {
+    return s.size() == 3 && all_of(s.begin(), s.end(), [](char c) { return c >= 'A' && c <= 'Z'; });
+}
+
+// Field positions are SSIM columns minus one. On failure `error` names the field.
+static bool parse_leg(string_view r, Leg& leg, const char*& error) {
+    if (r.size() < MIN_LEG_RECORD) { error = "record too short"; return false; }
+
+    string_view airline = trim(r.substr(2, 3));
+    if (airline.size() < 2 || !all_of(airline.begin(), airline.end(), [](char c) { return isalnum((unsigned char)c); })) {
+        error = "bad airline designator"; return false;
+    }
+    string_view number = trim(r.substr(5, 4));
+    if (!is_digits(number)) { error = "bad flight number"; return false; }
+    while (number.size() > 1 && number[0] == '0') number.remove_prefix(1);
+    // Pasted into flight ids and the JSON written by hand, so no escaping needed
+    if (r[1] != ' ' && (r[1] < 'A' || r[1] > 'Z')) { error = "bad operational suffix"; return false; }
+    if (!is_digits(r.substr(9, 2)) || !is_digits(r.substr(11, 2))) { error = "bad variation or leg number"; return false; }
+
+    if (!parse_ssim_date(r.substr(14, 7), leg.first_day) || leg.first_day == INDEFINITE ||
+        !parse_ssim_date(r.substr(21, 7), leg.last_day)) {
+        error = "bad period of operation"; return false;
+    }
+    if (leg.last_day != INDEFINITE && leg.last_day < leg.first_day) { error = "period ends before it starts"; return false; }
+
+    leg.days = 0;
+    for (int i = 0; i < 7; ++i) {
+        char c = r[28 + i];
+        if (c == '1' + i) leg.days |= (uint8_t)(1 << i);
+        else if (c != ' ') { error = "bad days of operation"; return false; }
+    }
+    if (!leg.days) { error = "no days of operation"; return false; }
+    char rate = r[35];
+    if (rate != ' ' && rate != '1' && rate != '2') { error = "bad frequency rate"; return false; }
+    leg.every_weeks = rate == '2' ? 2 : 1;
+
+    string_view from = r.substr(36, 3), to = r.substr(54, 3);
+    if (!is_station(from) || !is_station(to) || from == to) { error = "bad station"; return false; }
+    int dep_offset, arr_offset;
+    if (!parse_hhmm(r.substr(39, 4), leg.dep) || !parse_hhmm(r.substr(61, 4), leg.arr)) {
+        error = "bad passenger departure or arrival time"; return false;
+    }
+    if (!parse_utc_offset(r.substr(47, 5), dep_offset) || !parse_utc_offset(r.substr(65, 5), arr_offset)) {
+        error = "bad UTC offset"; return false;
+    }
+
+    // Block time from UTC; a leg is assumed to take under 24 hours
+    leg.duration = ((leg.arr - arr_offset) - (leg.dep - dep_offset)) % 1440;
+    if (leg.duration <= 0) leg.duration += 1440;
+
+    leg.airline.assign(airline);
+    leg.number.assign(number);
+    leg.suffix = r[1];
+    leg.variation = to_int(r.substr(9, 2));
+    leg.seq = to_int(r.substr(11, 2));
+    leg.from.assign(from);
+    leg.to.assign(to);
+    string_view aircraft = trim(r.substr(72, 3));
+    if (!all_of(aircraft.begin(), aircraft.end(), [](char c) { return isalnum((unsigned char)c); })) {
+        error = "bad aircraft type"; return false;
+    }
+    leg.aircraft.assign(aircraft);
+    return true;
+}
+
+// ==========================================
+// IMPORT
+// ==========================================
+
+struct Options {
+    string input, db_out, patterns_out, base, airlines;
+    bool keep_flights = false;
+    int from_day = INT32_MIN + 1, to_day = INT32_MAX - 1;
+    bool window_end = false;
+    double fare_base = 1500, fare_per_km = 4.5;
+    int capacity = DEFAULT_FLIGHT_CAPACITY;
+    unsigned threads = 0;
+    double target = 0;
+};
+
+struct Dated {
+    uint32_t leg; // Index into the chunk's legs
+    int day;
+    string id;    // Cleared when it duplicates an earlier flight
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t first_line = 0, lines = 0;
+    size_t records = 0, skipped = 0, rejected = 0, out_of_window = 0;
+    vector<Leg> legs;
+    vector<Dated> flights;
+    vector<pair<size_t, string>> errors; // Line within the chunk, message
+    string text;                         // Comma-joined flight objects
+    string patterns;                     // Pattern lines
+};
+
+struct Station {
+    double lat, lng;
+    bool placeholder;
+};
+
+// Distance fare when both stations have coordinates, otherwise the base fare
+static int fare(const Options& opt, const unordered_map<string, Station>& stations, const Leg& leg) {
+    auto a = stations.find(leg.from), b = stations.find(leg.to);
+    double km = 0;
+    if (a != stations.end() && b != stations.end())
+        km = GeoIndex::distance_km(a->second.lat, a->second.lng, b->second.lat, b->second.lng);
+    return (int)(opt.fare_base + opt.fare_per_km * km + 0.5);
+}
+
+static string flight_id(const Leg& leg, int day) {
+    int y, m, d;
+    civil_from_days(day, y, m, d);
+    char date[16];
+    snprintf(date, sizeof(date), "%04d%02d%02d", y, m, d);
+    string id = leg.airline + leg.number;
+    if (leg.suffix != ' ') id += leg.suffix;
+    id += '-';
+    id += date;
+    if (leg.seq > 1) id += "-L" + to_string(leg.seq);
+    return id;
+}
+
+// Parses every record in the chunk and expands its legs into dated flights
+static void parse_chunk(Chunk& c, bool fixed, const Options& opt, const unordered_map<string, Station>& stations) {
+    const char* p = c.begin;
+    while (p < c.end) {
+        const char* next;
+        string_view rec;
+        if (fixed) {
+            next = min(p + SSIM_RECORD, c.end);
+            rec = string_view(p, (size_t)(next - p));
+        } else {
+            const char* nl = (const char*)memchr(p, '\n', (size_t)(c.end - p));
+            next = nl ? nl + 1 : c.end;
+            rec = string_view(p, (size_t)((nl ? nl : c.end) - p));
+            if (!rec.empty() && rec.back() == '\r') rec.remove_suffix(1);
+        }
+        size_t line = c.lines++;
+        p = next;
+
+        if (rec.empty() || rec[0] != '3') {
+            c.skipped++;
+            continue;
+        }
+        c.records++;
+        Leg leg;
+        const char* error = nullptr;
+        if (!parse_leg(rec, leg, error)) {
+            c.rejected++;
+            if (c.errors.size() < MAX_ERRORS) c.errors.push_back({line, error});
+            continue;
+        }
+        if (leg.last_day == INDEFINITE) leg.last_day = opt.window_end ? opt.to_day : leg.first_day + 364;
+        leg.price = fare(opt, stations, leg);
+
+        uint32_t index = (uint32_t)c.legs.size();
+        size_t before = c.flights.size();
+        if (!opt.db_out.empty()) {
+            int first = max(leg.first_day, opt.from_day), last = min(leg.last_day, opt.to_day);
+            for (int day = first; day <= last; ++day) {
+                if (!((leg.days >> (weekday(day) - 1)) & 1)) continue;
+                if (leg.every_weeks > 1 && ((day - leg.first_day) / 7) % leg.every_weeks) continue;
+                c.flights.push_back({index, day, flight_id(leg, day)});
+            }
+            if (c.flights.size() == before) c.out_of_window++;
+        }
+        c.legs.push_back(move(leg));
+    }
+}
+
+// Flight objects in the order and with the keys of to_json(Flight)
+static void render_chunk(Chunk& c, const Options& opt, const unordered_map<string, string>& airline_json) {
+    string& out = c.text;
+    out.reserve(c.flights.size() * 200);
+    string duration;
+    for (const Dated& f : c.flights) {
+        if (f.id.empty()) continue;
+        const Leg& leg = c.legs[f.leg];
+        if (!out.empty()) out += ',';
+        out += "\n{\"id\":\"";
+        out += f.id;
+        out += "\",\"airline\":";
+        out += airline_json.at(leg.airline);
+        out += ",\"from_code\":\"" + leg.from;
+        out += "\",\"to_code\":\"" + leg.to;
+        out += "\",\"date\":\"" + iso_date(f.day);
+        out += "\",\"departure\":\"" + hhmm(leg.dep);
+        out += "\",\"arrival\":\"" + hhmm(leg.arr);
+        out += "\",\"duration\":\"" + to_string(leg.duration / 60) + "h ";
+        out += (leg.duration % 60 < 10 ? "0" : "") + to_string(leg.duration % 60) + "m";
+        out += "\",\"price\":" + to_string(leg.price);
+        out += ",\"capacity\":" + to_string(opt.capacity);
+        out += '}';
+    }
+}
+
+// One JSON object per line, recurrence as in the record
+static void render_patterns(Chunk& c, const unordered_map<string, string>& airline_json) {
+    string& out = c.patterns;
+    out.reserve(c.legs.size() * 320);
+    for (const Leg& leg : c.legs) {
+        string days = ".......";
+        for (int i = 0; i < 7; ++i) {
+            if ((leg.days >> i) & 1) days[i] = (char)('1' + i);
+        }
+        out += "{\"airline\":" + airline_json.at(leg.airline);
+        out += ",\"designator\":\"" + leg.airline;
+        out += "\",\"flight_number\":\"" + leg.number;
+        if (leg.suffix != ' ') out += leg.suffix;
+        out += "\",\"variation\":" + to_string(leg.variation);
+        out += ",\"leg\":" + to_string(leg.seq);
+        out += ",\"from_code\":\"" + leg.from;
+        out += "\",\"to_code\":\"" + leg.to;
+        out += "\",\"period_from\":\"" + iso_date(leg.first_day);
+        out += "\",\"period_to\":\"" + iso_date(leg.last_day);
+        out += "\",\"days\":\"" + days;
+        out += "\",\"every_weeks\":" + to_string(leg.every_weeks);
+        out += ",\"departure\":\"" + hhmm(leg.dep);
+        out += "\",\"arrival\":\"" + hhmm(leg.arr);
+        out += "\",\"duration_minutes\":" + to_string(leg.duration);
+        out += ",\"aircraft\":\"" + leg.aircraft;
+        out += "\",\"price\":" + to_string(leg.price);
+        out += "}\n";
+    }
+}
+
+// Splits [data, data + size) into about n pieces that end on record boundaries
+static vector<Chunk> split(const char* data, size_t size, size_t n, bool fixed) {
+    vector<Chunk> chunks;
+    const char* begin = data;
+    const char* end = data + size;
+    for (size_t i = 1; i <= n && begin < end; ++i) {
+        const char* cut = data + size * i / n;
+        if (i == n) {
+            cut = end;
+        } else if (fixed) {
+            cut = data + (size_t)(cut - data) / SSIM_RECORD * SSIM_RECORD;
+        } else {
+            const char* nl = (const char*)memchr(cut, '\n', (size_t)(end - cut));
+            cut = nl ? nl + 1 : end;
+        }
+        if (cut <= begin) continue;
+        Chunk c;
+        c.begin = begin;
+        c.end = cut;
+        chunks.push_back(move(c));
+        begin = cut;
+    }
+    return chunks;
+}
+
+template <typename F>
+static void parallel_for(vector<Chunk>& chunks, unsigned threads, F fn) {
+    vector<thread> pool;
+    atomic<size_t> next{0};
+    for (unsigned t = 0; t < min<size_t>(threads, chunks.size()); ++t) {
+        pool.emplace_back([&]() {
+            for (size_t i; (i = next.fetch_add(1)) < chunks.size();) fn(chunks[i]);
+        });
+    }
+    for (auto& th : pool) th.join();
+}
+
+// Writes through a temporary file, so a failed run leaves `path` as it was
+static bool write_file(const string& path, const function<void(ofstream&)>& body) {
+    string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        body(out);
+        if (!out) {
+            cerr << "[ERROR] Cannot write " << tmp << endl;
+            return false;
+        }
+    }
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(path.c_str()); // Windows will not rename over a file
+        if (rename(tmp.c_str(), path.c_str()) != 0) {
+            cerr << "[ERROR] Cannot replace " << path << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void usage() {
+    cerr << "Usage: ssim_import <schedule.ssim> [--db FILE] [--patterns FILE] [--base FILE] [--keep-flights]\n"
+            "                   [--from YYYY-MM-DD] [--to YYYY-MM-DD] [--airlines FILE]\n"
+            "                   [--fare-base N] [--fare-per-km X] [--capacity N] [--threads N] [--target N]\n";
+}
+
+static bool parse_args(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--keep-flights") { opt.keep_flights = true; continue; }
+        if (arg.rfind("--", 0) != 0) {
+            if (!opt.input.empty()) return false;
+            opt.input = arg;
+            continue;
+        }
+        if (!has_value) return false;
+        string v = argv[++i];
+        try {
+            if (arg == "--db") opt.db_out = v;
+            else if (arg == "--patterns") opt.patterns_out = v;
+            else if (arg == "--base") opt.base = v;
+            else if (arg == "--airlines") opt.airlines = v;
+            else if (arg == "--from") { if (!parse_iso_date(v, opt.from_day)) return false; }
+            else if (arg == "--to") { if (!parse_iso_date(v, opt.to_day)) return false; opt.window_end = true; }
+            else if (arg == "--fare-base") opt.fare_base = stod(v);
+            else if (arg == "--fare-per-km") opt.fare_per_km = stod(v);
+            else if (arg == "--capacity") opt.capacity = stoi(v);
+            else if (arg == "--threads") opt.threads = (unsigned)stoi(v);
+            else if (arg == "--target") opt.target = stod(v);
+            else return false;
+        } catch (...) {
+            return false;
+        }
+    }
+    return !opt.input.empty() && (!opt.db_out.empty() || !opt.patterns_out.empty()) && opt.capacity > 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, opt)) {
+        usage();
+        return 1;
+    }
+    if (!opt.threads) opt.threads = max(1u, thread::hardware_concurrency());
+    auto t_start = import_clock::now();
+
+    // Base database: airports with coordinates for fares, optionally flights
+    json base = json::object();
+    if (!opt.base.empty()) {
+        ifstream in(opt.base);
+        try {
+            in >> base;
+        } catch (const exception& ex) {
+            cerr << "[ERROR] Cannot read base database " << opt.base << ": " << ex.what() << endl;
+            return 1;
+        }
+    }
+    json airports = base.value("airports", json::array());
+    unordered_map<string, Station> stations;
+    int max_airport_id = 0;
+    for (const auto& a : airports) {
+        stations[a.value("code", "")] = {a.value("lat", 0.0), a.value("long", 0.0), false};
+        max_airport_id = max(max_airport_id, a.value("id", 0));
+    }
+
+    unordered_map<string, string> airline_names;
+    if (!opt.airlines.empty()) {
+        ifstream in(opt.airlines);
+        if (!in) {
+            cerr << "[ERROR] Cannot read " << opt.airlines << endl;
+            return 1;
+        }
+        string line;
+        while (getline(in, line)) {
+            size_t comma = line.find(',');
+            if (comma == string::npos) continue;
+            string name = line.substr(comma + 1);
+            if (!name.empty() && name.back() == '\r') name.pop_back();
+            airline_names[string(trim(string_view(line).substr(0, comma)))] = name;
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(opt.input)) {
+        cerr << "[ERROR] Cannot open " << opt.input << endl;
+        return 1;
+    }
+
+    // Files written without line breaks are a run of 200-byte records
+    size_t probe = min(file.size(), SSIM_RECORD + 1);
+    bool fixed_width = file.size() > 0 && file.size() % SSIM_RECORD == 0 && !memchr(file.data(), '\n', probe);
+
+    // ---- Parse and expand (parallel) ----
+    auto t0 = import_clock::now();
+    vector<Chunk> chunks = split(file.data(), file.size(), (size_t)opt.threads * 4, fixed_width);
+    parallel_for(chunks, opt.threads, [&](Chunk& c) { parse_chunk(c, fixed_width, opt, stations); });
+    double parse_ms = chrono::duration<double, milli>(import_clock::now() - t0).count();
+
+    size_t records = 0, skipped = 0, rejected = 0, legs = 0, out_of_window = 0, lines = 0;
+    for (auto& c : chunks) {
+        c.first_line = lines;
+        lines += c.lines;
+        records += c.records;
+        skipped += c.skipped;
+        rejected += c.rejected;
+        legs += c.legs.size();
+        out_of_window += c.out_of_window;
+    }
+    size_t shown = 0;
+    for (const auto& c : chunks) {
+        for (const auto& e : c.errors) {
+            if (shown++ < MAX_ERRORS) cerr << "[WARN] line " << c.first_line + e.first + 1 << ": " << e.second << endl;
+        }
+    }
+
+    // Stations missing from the base become placeholder airports, airlines
+    // without a name keep their designator
+    size_t placeholders = 0;
+    unordered_map<string, string> airline_json;
+    for (const auto& c : chunks) {
+        for (const auto& leg : c.legs) {
+            for (const string* code : {&leg.from, &leg.to}) {
+                if (stations.count(*code)) continue;
+                stations[*code] = {0, 0, true};
+                airports.push_back(Airport{++max_airport_id, *code, *code, *code, 0, 0});
+                placeholders++;
+            }
+            if (!airline_json.count(leg.airline)) {
+                auto it = airline_names.find(leg.airline);
+                airline_json[leg.airline] = json(it != airline_names.end() ? it->second : leg.airline).dump();
+            }
+        }
+    }
+
+    cout << fixed << setprecision(1);
+    cout << "[INFO] Parsed " << records << " leg records (" << rejected << " rejected, " << skipped
+         << " other records skipped) in " << parse_ms << " ms with " << opt.threads << " threads: "
+         << setprecision(0) << (records / max(parse_ms, 0.001) * 1000) << " records/s" << endl;
+
+    // ---- Recurrence patterns, one line per leg ----
+    if (!opt.patterns_out.empty()) {
+        parallel_for(chunks, opt.threads, [&](Chunk& c) { render_patterns(c, airline_json); });
+        bool ok = write_file(opt.patterns_out, [&](ofstream& out) {
+            for (const auto& c : chunks) out.write(c.patterns.data(), (streamsize)c.patterns.size());
+        });
+        if (!ok) return 1;
+        cout << "[INFO] Wrote " << legs << " patterns to " << opt.patterns_out << endl;
+    }
+
+    // ---- Dated flights as a server database ----
+    if (!opt.db_out.empty()) {
+        json kept = opt.keep_flights ? base.value("flights", json::array()) : json::array();
+
+        // First one wins: base flights, then file order
+        auto t1 = import_clock::now();
+        size_t total = 0, duplicates = 0;
+        for (const auto& c : chunks) total += c.flights.size();
+        unordered_set<string> ids;
+        ids.reserve(total + kept.size());
+        for (const auto& f : kept) ids.insert(f.value("id", ""));
+        for (auto& c : chunks) {
+            for (auto& f : c.flights) {
+                if (ids.insert(f.id).second) continue;
+                f.id.clear();
+                duplicates++;
+            }
+        }
+
+        parallel_for(chunks, opt.threads, [&](Chunk& c) { render_chunk(c, opt, airline_json); });
+
+        bool ok = write_file(opt.db_out, [&](ofstream& out) {
+            out << "{\"airports\":" << airports.dump() << ",\"flights\":[";
+            bool first = true;
+            for (const auto& f : kept) {
+                out << (first ? "\n" : ",\n") << f.dump();
+                first = false;
+            }
+            for (const auto& c : chunks) {
+                if (c.text.empty()) continue;
+                if (!first) out << ',';
+                out.write(c.text.data(), (streamsize)c.text.size());
+                first = false;
+            }
+            out << "\n]}\n";
+        });
+        if (!ok) return 1;
+        double write_ms = chrono::duration<double, milli>(import_clock::now() - t1).count();
+        cout << setprecision(1) << "[INFO] Wrote " << total - duplicates << " flights (" << duplicates << " duplicate ids dropped, "
+             << out_of_window << " legs outside the window) and " << airports.size() << " airports ("
+             << placeholders << " placeholders without coordinates) to " << opt.db_out << " in " << write_ms << " ms"
+             << endl;
+    }
+
+    double total_ms = chrono::duration<double, milli>(import_clock::now() - t_start).count();
+    double rate = records / max(total_ms, 0.001) * 1000;
+    cout << setprecision(1) << "[INFO] Total " << total_ms << " ms: " << setprecision(0) << rate << " records/s";
+    if (opt.target > 0) cout << " (target " << opt.target << ": " << (rate >= opt.target ? "met" : "MISSED") << ")";
+    cout << endl;
+    return opt.target > 0 && rate < opt.target ? 3 : 0;
+}
@@ -0,0 +1,177 @@
+#include "unix_socket_server.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+
+using namespace std;
+
+static const size_t MAX_HEAD_BYTES = 64 * 1024;
+static const size_t MAX_BODY_BYTES = 16 * 1024 * 1024;
+
+static bool send_error(int fd, int code);
+
+UnixSocketServer::UnixSocketServer(string p, Handler h, size_t max_connections)
+    : path(move(p)), handler(move(h)),
+      listener([this](int fd) { serve(fd); }, max_connections, [](int fd) { send_error(fd, 503); }) {}
+
+bool UnixSocketServer::start(string& error) {
+    return listener.listen_unix(path, error);
+}
+
+void UnixSocketServer::stop() {
+    listener.stop();
+}
+
+// ==========================================
+// HTTP/1.1 FRAMING
+// ==========================================
+
+static bool send_all(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += (size_t)n;
+    }
+    return true;
+}
+
+// Appends whatever the peer sent next; false on close or error
+static bool recv_more(int fd, string& buf) {
+    char chunk[16 * 1024];
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf.append(chunk, (size_t)n);
+        return true;
+    }
+}
+
+static string lowered(string s) {
+    for (char& c : s) c = (char)tolower((unsigned char)c);
+    return s;
+}
+
+static const char* reason_phrase(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+static bool send_response(int fd, const LocalResponse& res, bool keep_alive) {
+    string out = "HTTP/1.1 " + to_string(res.code) + " " + reason_phrase(res.code) + "\r\n";
+    for (const auto& h : res.headers) {
+        string name = lowered(h.first);
+        if (name == "content-length" || name == "connection") continue; // Ours below
+        out += h.first + ": " + h.second + "\r\n";
+    }
+    out += "Content-Length: " + to_string(res.body.size()) + "\r\n";
+    out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    out += res.body;
+    return send_all(fd, out);
+}
+
+static bool send_error(int fd, int code) {
+    LocalResponse res;
+    res.code = code;
+    res.body = reason_phrase(code);
+    send_response(fd, res, false);
+    return false;
+}
+
+// Parses the request line and headers; 0 when valid, else the status to reply with
+static int parse_head(const string& head, LocalRequest& req, bool& keep_alive, size_t& length) {
+    size_t line_end = head.find("\r\n");
+    string line = head.substr(0, line_end);
+    size_t sp1 = line.find(' '), sp2 = line.rfind(' ');
+    if (sp1 == string::npos || sp2 == sp1) return 400;
+    req.method = line.substr(0, sp1);
+    req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    string version = line.substr(sp2 + 1);
+    if (version.compare(0, 5, "HTTP/") != 0) return 400;
+    keep_alive = version != "HTTP/1.0";
+    length = 0;
+
+    size_t pos = line_end == string::npos ? head.size() : line_end + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == string::npos) end = head.size();
+        size_t colon = head.find(':', pos);
+        if (colon == string::npos || colon > end) return 400;
+        string name = head.substr(pos, colon - pos);
+        size_t v = colon + 1;
+        while (v < end && head[v] == ' ') v++;
+        string value = head.substr(v, end - v);
+        pos = end + 2;
+
+        string key = lowered(name);
+        if (key == "content-length") {
+            try { length = stoul(value); } catch (...) { return 400; }
+            if (length > MAX_BODY_BYTES) return 413;
+        } else if (key == "transfer-encoding") {
+            return 501; // No chunked bodies; local clients send Content-Length
+        } else if (key == "connection") {
+            string c = lowered(value);
+            if (c == "close") keep_alive = false;
+            else if (c == "keep-alive") keep_alive = true;
+        }
+        req.headers.push_back({move(name), move(value)});
+    }
+    return 0;
+}
+
+// ==========================================
+// CONNECTIONS
+// ==========================================
+
+void UnixSocketServer::serve(int fd) {
+    string buf;
+    while (true) {
+        size_t head_end;
+        bool open = true;
+        while ((head_end = buf.find("\r\n\r\n")) == string::npos) {
+            if (buf.size() > MAX_HEAD_BYTES) { open = send_error(fd, 431); break; }
+            if (!recv_more(fd, buf)) { open = false; break; }
+        }
+        if (!open) break;
+
+        LocalRequest req;
+        bool keep_alive = true;
+        size_t length = 0;
+        if (int status = parse_head(buf.substr(0, head_end), req, keep_alive, length)) {
+            send_error(fd, status);
+            break;
+        }
+        size_t body_start = head_end + 4;
+        while (open && buf.size() < body_start + length) open = recv_more(fd, buf);
+        if (!open) break;
+        req.body = buf.substr(body_start, length);
+        buf.erase(0, body_start + length);
+
+        LocalResponse res;
+        try {
+            handler(req, res);
+        } catch (const exception& e) {
+            res = LocalResponse();
+            res.code = 500;
+            res.body = e.what();
+        }
+        if (!send_response(fd, res, keep_alive) || !keep_alive) break;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef UNIX_SOCKET_SERVER_H
+#define UNIX_SOCKET_SERVER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "socket_listener.h"
+
+// One HTTP/1.1 exchange on the local socket, independent of Crow
+struct LocalRequest {
+    std::string method, target, body; // target keeps its query string
+    std::vector<std::pair<std::string, std::string>> headers;
+};
+
+struct LocalResponse {
+    int code = 200;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+};
+
+// HTTP/1.1 over a Unix domain socket for clients on the same host. Each
+// connection (see SocketListener) parses keep-alive requests (Content-Length
+// bodies only) and passes them to the handler, which main routes through
+// the same Crow app as TCP. POSIX only.
+class UnixSocketServer {
+public:
+    typedef std::function<void(const LocalRequest&, LocalResponse&)> Handler;
+
+    UnixSocketServer(std::string path, Handler handler, size_t max_connections = 64);
+
+    // Binds the socket (replacing a stale one at path) and starts accepting
+    bool start(std::string& error);
+    // Closes the listener and every open connection, then removes the socket file
+    void stop();
+
+private:
+    void serve(int fd);
+
+    const std::string path;
+    const Handler handler;
+    SocketListener listener;
+};
+
+#endif